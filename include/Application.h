@@ -8,6 +8,9 @@
 #include <utility>
 #include <Scene.h>
 #include <ResourceRegistry.h>
+#include <Tilemap.h>
+#include <Tileset.h>
+#include <TextureAtlas.h>
 #include <ThreadPool.h>
 
 ////////////////////////////////////////////////////////////
@@ -63,6 +66,88 @@ public:
     ////////////////////////////////////////////////////////////
     [[nodiscard]] inline TextureRegistry& GetTextureRegistry() { return m_textureRegistry; }
 
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the image registry
+    ///
+    /// The image registry is used to load and store images kept
+    /// in RAM (for example to be processed before being uploaded).
+    ///
+    /// \return A reference to the image registry
+    ///
+    /// \see ImageRegistry
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline ImageRegistry& GetImageRegistry() { return m_imageRegistry; }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the font registry
+    ///
+    /// \return A reference to the font registry
+    ///
+    /// \see FontRegistry
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline FontRegistry& GetFontRegistry() { return m_fontRegistry; }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the sound buffer registry
+    ///
+    /// \return A reference to the sound buffer registry
+    ///
+    /// \see SoundBufferRegistry
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline SoundBufferRegistry& GetSoundBufferRegistry() { return m_soundBufferRegistry; }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the shader registry
+    ///
+    /// \return A reference to the shader registry
+    ///
+    /// \see ShaderRegistry
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline ShaderRegistry& GetShaderRegistry() { return m_shaderRegistry; }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the tilemap registry
+    ///
+    /// The tilemap registry stores the parsed tilemaps, so that
+    /// they are shared by the scenes using them.
+    ///
+    /// \return A reference to the tilemap registry
+    ///
+    /// \see TilemapRegistry
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline TilemapRegistry& GetTilemapRegistry() { return m_tilemapRegistry; }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the tileset registry
+    ///
+    /// The tileset registry stores the tilesets, padded and
+    /// mipmapped for the game grids.
+    ///
+    /// \return A reference to the tileset registry
+    ///
+    /// \see TilesetRegistry
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline TilesetRegistry& GetTilesetRegistry() { return m_tilesetRegistry; }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the texture atlas
+    ///
+    /// The texture atlas packs the small images used by sprites
+    /// in a few textures.
+    ///
+    /// \return A reference to the texture atlas
+    ///
+    /// \see TextureAtlas
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline TextureAtlas& GetTextureAtlas() { return m_textureAtlas; }
+
     ////////////////////////////////////////////////////////////
     /// \brief  Returns the the thread pool
     ///
@@ -75,7 +160,18 @@ public:
     ////////////////////////////////////////////////////////////
     [[nodiscard]] inline ThreadPool& GetThreadPool() { return m_threadPool; }
 
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the statistics of all the registries
+    ///
+    /// \return the statistics of each registry
+    ///
+    /// \see ResourceStatisticsReport
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] std::vector<ResourceRegistryStatistics> GetResourceStatistics();
+
     static constexpr const char* WINDOW_TITLE = "Stardew";
+    static constexpr const char* RESOURCE_STATISTICS_PATH = "resource_statistics.json";
     static constexpr uint32_t WINDOW_WIDTH = 800;
     static constexpr uint32_t WINDOW_HEIGHT = 600;
 
@@ -131,6 +227,15 @@ private:
     sf::RenderWindow m_window;
 
     TextureRegistry m_textureRegistry;
+    ImageRegistry m_imageRegistry;
+    FontRegistry m_fontRegistry;
+    SoundBufferRegistry m_soundBufferRegistry;
+    ShaderRegistry m_shaderRegistry;
+    TilemapRegistry m_tilemapRegistry;
+    TilesetRegistry m_tilesetRegistry;
+
+    // Declared after the registries because it holds handles to their resources
+    TextureAtlas m_textureAtlas;
 
     sf::Clock m_clock;
     float m_timer = 0.0f;
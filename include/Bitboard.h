@@ -0,0 +1,95 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+/// \brief  A packed grid of bits
+///
+/// Each row of the grid is stored in 64 bits words, the bit x
+/// of a row being the bit x % 64 of the word x / 64. The rows
+/// start on a new word, so a row of a rectangle is a run of
+/// contiguous words, and the queries on rectangles test 64
+/// tiles per operation instead of one.
+///
+////////////////////////////////////////////////////////////
+class Bitboard
+{
+public:
+    Bitboard() = default;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Creates a bitboard with every bit cleared
+    ///
+    /// \param width the number of columns
+    /// \param height the number of rows
+    ///
+    ////////////////////////////////////////////////////////////
+    Bitboard(uint32_t width, uint32_t height);
+
+    [[nodiscard]] inline bool Get(uint32_t x, uint32_t y) const
+    {
+        return (m_words[static_cast<size_t>(y) * m_wordsPerRow + x / 64] >> (x % 64)) & 1;
+    }
+
+    inline void Set(uint32_t x, uint32_t y, bool value)
+    {
+        uint64_t& word = m_words[static_cast<size_t>(y) * m_wordsPerRow + x / 64];
+        uint64_t bit = uint64_t(1) << (x % 64);
+        word = value ? word | bit : word & ~bit;
+    }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns true if a bit of a rectangle is set
+    ///
+    /// The rectangle must be inside of the bitboard.
+    ///
+    /// \param x the first column of the rectangle
+    /// \param y the first row of the rectangle
+    /// \param width the number of columns of the rectangle
+    /// \param height the number of rows of the rectangle
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] bool Any(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns true if every bit of a rectangle is set
+    ///
+    /// \see Any
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] bool All(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the number of bits set in a rectangle
+    ///
+    /// \see Any
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] uint64_t Count(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const;
+
+    [[nodiscard]] inline uint32_t GetWidth() const { return m_width; }
+    [[nodiscard]] inline uint32_t GetHeight() const { return m_height; }
+    [[nodiscard]] inline uint64_t GetMemorySize() const { return m_words.size() * sizeof(uint64_t); }
+
+private:
+    ////////////////////////////////////////////////////////////
+    /// \brief  Calls a function with the words of a rectangle
+    ///
+    /// \param function called with each word of the rectangle and the
+    ///        mask of the bits of the word inside of the rectangle, it
+    ///        returns false to stop
+    ///
+    ////////////////////////////////////////////////////////////
+    template<typename F>
+    void ForEachWord(uint32_t x, uint32_t y, uint32_t width, uint32_t height, F&& function) const;
+
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_wordsPerRow = 0;
+    std::vector<uint64_t> m_words;
+};
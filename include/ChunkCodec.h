@@ -0,0 +1,71 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+/// \brief  A small LZ codec for the tiles of the chunks
+///
+/// The tilemaps are mostly made of large areas of the same tiles,
+/// so the codec favors runs: the data is a list of sequences, each
+/// one made of literal bytes followed by a copy of earlier output.
+/// A copy may overlap its own output, so a run of a byte (or of a
+/// 16 bits texture index) is a copy at an offset of 1 (or 2). The
+/// longer copies are found through a hash of the next bytes.
+///
+/// Sequence:
+/// ------------------------------------------------------------------------
+/// | token   | literalCount+ | literals  | offset   | copyLength+ |
+/// ------------------------------------------------------------------------
+/// | uint8_t | uint8_t[]     | uint8_t[] | uint16_t | uint8_t[]   |
+/// ------------------------------------------------------------------------
+///
+/// The 4 high bits of the token are the number of literals, the 4
+/// low bits are the length of the copy minus MIN_COPY_LENGTH. When
+/// a count is 15, the next bytes are added to it until a byte is
+/// not 255. The last sequence only has literals.
+///
+/// Each buffer is independent, so each chunk of a file can be
+/// decompressed on its own (see Tilemap::ChunkEncoding).
+///
+////////////////////////////////////////////////////////////
+class ChunkCodec
+{
+public:
+    ChunkCodec() = delete;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Compresses a buffer
+    ///
+    /// \param data the buffer to compress
+    /// \param size the size of the buffer, at most MAX_SIZE bytes
+    /// \param compressed the compressed buffer, replaced
+    ///
+    ////////////////////////////////////////////////////////////
+    static void Compress(const uint8_t* data, uint32_t size, std::vector<uint8_t>& compressed);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Decompresses a buffer
+    ///
+    /// Every read and write is checked, an invalid buffer is
+    /// rejected without reading or writing out of the buffers.
+    ///
+    /// \param compressed the compressed buffer
+    /// \param compressedSize the size of the compressed buffer
+    /// \param data the decompressed buffer
+    /// \param size the size of the decompressed buffer
+    /// \return false if the buffer is invalid or does not decompress to
+    ///         exactly size bytes
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool Decompress(const uint8_t* compressed, uint32_t compressedSize, uint8_t* data, uint32_t size);
+
+    // The size of the biggest buffer, the offsets of the copies are 16 bits
+    static constexpr uint32_t MAX_SIZE = 65535;
+
+    static constexpr uint32_t MIN_COPY_LENGTH = 3;
+};
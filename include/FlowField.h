@@ -0,0 +1,144 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+
+class GameGrid;
+class ThreadPool;
+
+////////////////////////////////////////////////////////////
+/// \brief  The directions to a destination from every tile of a region
+///
+/// A flow field is made for the crowds walking to the same
+/// destination: it is computed once, then each NPC follows the
+/// direction of its tile, without searching a path.
+///
+/// The integration field is the cost of the cheapest path from
+/// each tile of the region to the destination, with the costs of
+/// the Pathfinder (a step costs the movement cost of the tile
+/// entered). The direction field points to the neighbor on this
+/// path.
+///
+/// The region is a square of chunks of the grid around the
+/// destination, the tiles outside of it have no direction. The
+/// integration field is computed by relaxing the chunks of the
+/// region in parallel: the chunks are colored like a checkerboard,
+/// and the chunks of one color run a Dijkstra search seeded by the
+/// borders of their neighbors, which do not change meanwhile. The
+/// chunks whose border improved run again, until no cost changes.
+///
+////////////////////////////////////////////////////////////
+class FlowField
+{
+public:
+    // The step to take from a tile
+    enum class Direction : uint8_t
+    {
+        // On the destination, or the destination cannot be reached
+        None,
+        Left,
+        Right,
+        Up,
+        Down
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Computes the flow field to a destination
+    ///
+    /// The calling thread takes part in the computation.
+    ///
+    /// \param grid the grid, which must not be modified during the computation
+    /// \param destination the tile the NPCs walk to, the field has no tile if
+    ///        it is outside of the grid or cannot be walked on
+    /// \param regionRadius the number of chunks of the region on each side of
+    ///        the chunk of the destination
+    /// \param threadPool the threads computing the field
+    ///
+    ////////////////////////////////////////////////////////////
+    FlowField(const GameGrid& grid, sf::Vector2u destination, uint32_t regionRadius, ThreadPool& threadPool);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns true if a tile is in the region of the field
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline bool Contains(uint32_t x, uint32_t y) const
+    {
+        return x >= m_firstX && y >= m_firstY && x - m_firstX < m_width && y - m_firstY < m_height;
+    }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the cost of the path from a tile to the destination
+    ///
+    /// \return the cost, or UNREACHABLE if there is no path in the region
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] uint32_t GetCost(uint32_t x, uint32_t y) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the direction to follow from a tile
+    ///
+    /// \return the direction, or Direction::None outside of the region
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] Direction GetDirection(uint32_t x, uint32_t y) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns true if the region of the field contains a chunk
+    ///
+    /// \param chunkX the x coordinate of the chunk, in chunks
+    /// \param chunkY the y coordinate of the chunk, in chunks
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline bool ContainsChunk(uint32_t chunkX, uint32_t chunkY) const
+    {
+        return chunkX >= m_firstChunkX && chunkY >= m_firstChunkY
+            && chunkX - m_firstChunkX < m_chunkCountX && chunkY - m_firstChunkY < m_chunkCountY;
+    }
+
+    [[nodiscard]] inline sf::Vector2u GetDestination() const { return m_destination; }
+    [[nodiscard]] inline uint64_t GetMemorySize() const { return m_costs.size() * sizeof(uint32_t) + m_directions.size(); }
+
+    static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+
+private:
+    ////////////////////////////////////////////////////////////
+    /// \brief  Lowers the costs of a chunk from the borders of its neighbors
+    ///
+    /// \param chunkX the x coordinate of the chunk in the region, in chunks
+    /// \param chunkY the y coordinate of the chunk in the region, in chunks
+    /// \return the borders of the chunk whose costs were lowered, one bit per
+    ///         side (left, right, top, bottom)
+    ///
+    ////////////////////////////////////////////////////////////
+    uint8_t RelaxChunk(uint32_t chunkX, uint32_t chunkY);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Sets the direction of the tiles of a row of the region
+    ///
+    ////////////////////////////////////////////////////////////
+    void UpdateDirections(uint32_t row);
+
+    // Only used while the field is computed
+    const std::vector<uint8_t>& m_movementCosts;
+    uint32_t m_gridWidth;
+    sf::Vector2u m_destination;
+
+    // The region, in tiles and in chunks of the grid
+    uint32_t m_firstX;
+    uint32_t m_firstY;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_firstChunkX;
+    uint32_t m_firstChunkY;
+    uint32_t m_chunkCountX;
+    uint32_t m_chunkCountY;
+
+    // Indexed by (y - m_firstY) * m_width + x - m_firstX
+    std::vector<uint32_t> m_costs;
+    std::vector<Direction> m_directions;
+};
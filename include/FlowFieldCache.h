@@ -0,0 +1,94 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "FlowField.h"
+
+////////////////////////////////////////////////////////////
+/// \brief  Keeps the flow fields of the recent destinations
+///
+/// The NPCs walking to the same destination share its flow
+/// field, which is only computed by the first one. A field stays
+/// in the cache until a tile of its region is replaced or a chunk
+/// of its region is loaded or unloaded (see Refresh), or until
+/// MAX_FIELD_COUNT other destinations were requested after it.
+///
+/// The fields are shared: an NPC can keep following a field
+/// removed from the cache until it asks for a new one.
+///
+////////////////////////////////////////////////////////////
+class FlowFieldCache
+{
+public:
+    ////////////////////////////////////////////////////////////
+    /// \brief  Creates an empty cache
+    ///
+    /// \param grid the grid, which must outlive the cache
+    /// \param threadPool the threads computing the fields
+    /// \param regionRadius the number of chunks of the region of a field on
+    ///        each side of the chunk of its destination
+    ///
+    ////////////////////////////////////////////////////////////
+    FlowFieldCache(const GameGrid& grid, ThreadPool& threadPool, uint32_t regionRadius = DEFAULT_REGION_RADIUS);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the flow field to a destination
+    ///
+    /// The field is computed if it is not in the cache.
+    ///
+    /// \param destination the tile the NPCs walk to
+    ///
+    ////////////////////////////////////////////////////////////
+    std::shared_ptr<const FlowField> GetFlowField(sf::Vector2u destination);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Removes the fields whose region changed
+    ///
+    /// It compares the versions and the loaded chunks of the grid with
+    /// the ones seen by the previous call, so it should be called after
+    /// the tiles are modified and the chunks are streamed. It returns
+    /// immediately if GameGrid::GetVersion did not change.
+    ///
+    ////////////////////////////////////////////////////////////
+    void Refresh();
+
+    void Clear();
+
+    [[nodiscard]] inline size_t GetFieldCount() const { return m_entries.size(); }
+
+    static constexpr uint32_t DEFAULT_REGION_RADIUS = 4;
+    static constexpr size_t MAX_FIELD_COUNT = 16;
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<const FlowField> field;
+        uint64_t lastUse;
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns true if the tiles of a chunk are in memory
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] bool IsChunkLoaded(uint32_t chunkIndex) const;
+
+    const GameGrid& m_grid;
+    ThreadPool& m_threadPool;
+    uint32_t m_regionRadius;
+
+    // A few entries, searched linearly
+    std::vector<Entry> m_entries;
+    uint64_t m_useCounter = 0;
+
+    // The grid at the last refresh: its version, and the version and the
+    // state of each chunk, a field computed with an unloaded chunk in its
+    // region treats it as a wall
+    uint64_t m_gridVersion;
+    std::vector<uint32_t> m_chunkVersions;
+    std::vector<bool> m_loadedChunks;
+};
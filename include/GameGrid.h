@@ -4,30 +4,45 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "ResourceRegistry.h"
+#include "Bitboard.h"
+#include "TileChunk.h"
+#include "TileScheduler.h"
+#include "Tilemap.h"
+#include "TilemapJournal.h"
+#include "TilemapStream.h"
+#include "Tileset.h"
 #include "GameObject.h"
 
-// The tile types the game supports (each type is associated to a class)
-enum class TileType : uint8_t
-{
-    Ground = 0,
-    Wall = 1,
-    PassagePoint = 2,
-    Path = 3,
-    Soil = 4
-};
-
 ////////////////////////////////////////////////////////////
 /// \brief  The grid system of the game
 ///
 /// This class is responsible for the grid system of the game.
 /// Using factory functions, like ReadFromFile, it can load
 /// a tilemap and a tileset, and use them to render a game grid
-/// efficently using a vertex array (it is only built when the
-/// map is modified).
+/// efficently. The grid is split in chunks of CHUNK_SIZE x CHUNK_SIZE
+/// tiles, each with its own vertex buffer kept on the GPU, and only
+/// the chunks containing modified tiles are rebuilt and uploaded.
+/// For very large maps, the grid can instead be drawn by a shader
+/// reading the texture index of each tile from a data texture (see
+/// RenderMode::Shader), which only needs a few bytes per tile.
+/// The tiles are stored in TileChunk, shared with the tilemap and
+/// the other grids created from the same file: the grid copies a
+/// chunk the first time it modifies it. The behavior of the tiles
+/// is implemented by the systems of Tiles.h.
+/// A grid created with StreamFromFile only keeps the tiles and
+/// the vertices of the chunks around the camera in memory, and
+/// reads the others from the file when the camera gets close to
+/// them.
+/// The destinations of the passage points near the camera are
+/// loaded in the background, so that the grid of a destination
+/// can be created without reading any file.
 /// This class is also responsible for the camera, using the
 /// camera position and zoom factor, it can render the grid
 /// at the right position and scale.
@@ -44,12 +59,14 @@ public:
     ////////////////////////////////////////////////////////////////////////////
     /// \brief  Updates the game grid
     ///
-    /// This function updates the game grid, it checks if the vertex array needs
-    /// to be rebuilt, and if so, it rebuilds it.
+    /// This function updates the game grid, it updates the active tiles with
+    /// the systems of their types, then it rebuilds the geometry of the
+    /// chunks containing modified tiles and uploads it (or only their texture
+    /// indices in RenderMode::Shader).
     ///
     /// \param deltaTime the time since the last frame
     ///
-    /// \see CreateVertexArray
+    /// \see CreateChunkVertices
     /// \see GameObject::Update
     ///
     ////////////////////////////////////////////////////////////////////////////
@@ -58,6 +75,8 @@ public:
     ////////////////////////////////////////////////////////////////////////////
     /// \brief  Renders the game grid
     ///
+    /// Only the chunks intersecting the view of the camera are drawn.
+    ///
     /// \param window the window to render to
     ///
     /// \see GameObject::Render
@@ -81,10 +100,102 @@ public:
     ////////////////////////////////////////////////////////////////////////////
     inline void SetCameraZoom(float zoomFactor) { m_zoomFactor = zoomFactor; }
 
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  The ways the grid can be drawn
+    ///
+    /// Both modes produce the same image.
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    enum class RenderMode
+    {
+        // Each chunk has a vertex buffer with 6 vertices per tile
+        Vertices,
+
+        // The texture indices of the tiles are stored in a RGBA8 texture, and
+        // a fragment shader looks up the tileset for each pixel of a single quad
+        Shader
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Changes the way the grid is drawn
+    ///
+    /// The change is applied on the next update, and the memory used by the
+    /// previous mode is released. If shaders are not available, or if the grid
+    /// is bigger than the maximum texture size, the grid stays in
+    /// RenderMode::Vertices.
+    ///
+    /// \param renderMode the new render mode
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    inline void SetRenderMode(RenderMode renderMode) { m_requestedRenderMode = renderMode; }
+
+    [[nodiscard]] inline RenderMode GetRenderMode() const { return m_renderMode; }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  The counters of the last rendered frame
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    struct RenderStatistics
+    {
+        uint32_t chunkCount = 0; // number of chunks of the grid
+        uint32_t chunksDrawn = 0; // number of chunks intersecting the view
+        uint64_t verticesDrawn = 0;
+        uint32_t drawCalls = 0;
+        RenderMode renderMode = RenderMode::Vertices;
+        uint64_t memorySize = 0; // memory used on the GPU by the vertices or the tile indices
+        uint32_t chunksLoaded = 0; // number of chunks in memory, all of them unless streaming
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the counters of the last rendered frame
+    ///
+    /// The cost of a frame depends on the area of the screen, not on the
+    /// area of the map.
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] inline RenderStatistics GetRenderStatistics() const { return m_renderStatistics; }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Measures the cost of a frame in each render mode and logs it
+    ///
+    /// The grid is drawn frameCount times in each mode over the current view,
+    /// without displaying the frames, and the time includes the work of the
+    /// GPU. The render mode of the grid is restored afterwards.
+    ///
+    /// \param window the window the frames are drawn to
+    /// \param frameCount the number of frames drawn in each mode
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void BenchmarkRender(sf::RenderWindow& window, uint32_t frameCount);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Measures the time to create the vertices of the loaded chunks
+    ///         and logs it
+    ///
+    /// The vertices are created in batches of REBUILD_BATCH_SIZE chunks, as in
+    /// a rebuild, on this thread and then on the thread pool. They are not
+    /// uploaded, the uploads are done by this thread in both cases.
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void BenchmarkRebuild() const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the point of the grid under a pixel of the window
+    ///
+    /// \param pixel the position of the pixel in the window
+    /// \return the point, in tiles (it can be outside of the grid)
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] sf::Vector2f MapPixelToTile(sf::Vector2i pixel) const;
+
     ////////////////////////////////////////////////////////////////////////////
     /// \brief  A factory function to create a game grid from a file
     ///
-    /// This function needs a path to a file in the HTF format described here :
+    /// The file is parsed only once, the parsed tilemap is kept in the
+    /// TilemapRegistry and shared by every grid created from it.
+    ///
+    /// This function needs a path to a file in the HTF format, of the version 1
+    /// or 2. The version 1 is described here :
     ///
     /// Header:
     /// -----------------------------------------------------------------------------------------------------------------
@@ -104,118 +215,811 @@ public:
     /// | 1        | 4        | 4            | size - 9  |
     /// --------------------------------------------------
     ///
+    /// The custom data of a tile is described by the system of its type (see Tiles.h).
+    ///
     /// Entity: TODO
-    /// \param path the path to the file
+    ///
+    /// The version 2 stores the tiles chunk by chunk, with an index of the chunks,
+    /// so any chunk can be read and parsed on its own. scripts/ConvertTilemap.cpp
+    /// converts a file of the version 1. The integers are little endian.
+    ///
+    /// Header:
+    /// ---------------------------------------------------------------------------
+    /// | magic    | version  | sectionCount | width    | height   | sections     |
+    /// ---------------------------------------------------------------------------
+    /// | uint32_t | uint16_t | uint16_t     | uint32_t | uint32_t | Section[]    |
+    /// ---------------------------------------------------------------------------
+    /// | 4        | 2        | 2            | 4        | 4        | 20 * count   |
+    /// ---------------------------------------------------------------------------
+    ///
+    /// The magic is "HTF2" and the version is 2. A section is a type (uint32_t),
+    /// then the offset of the section in the file and its size (uint64_t). The
+    /// sections of an unknown type are ignored:
+    /// - 1, TilesetPath: char[]
+    /// - 2, ChunkIndex: Chunk[], one per chunk in row-major order
+    /// - 3, Tiles: the tiles of the chunks, in the encoding of their Chunk
+    /// - 4, TileData: TileData[], the custom data of the tiles
+    ///
+    /// Chunk:
+    /// --------------------------------------------------------------
+    /// | tilesOffset | tilesSize | encoding | dataOffset | dataSize |
+    /// --------------------------------------------------------------
+    /// | uint64_t    | uint32_t  | uint32_t | uint64_t   | uint32_t |
+    /// --------------------------------------------------------------
+    ///
+    /// The offsets are relative to the Tiles and TileData sections. With the
+    /// encoding 0 (raw), the tiles of a chunk are the types of its CHUNK_SIZE x
+    /// CHUNK_SIZE cells (uint8_t[]), then their texture indices (uint16_t[]), the
+    /// cells outside of the map included. With the encoding 1 (compressed), they
+    /// are compressed with ChunkCodec. The data of a chunk is the custom data
+    /// of its tiles, sorted by cell (y * CHUNK_SIZE + x):
+    ///
+    /// TileData:
+    /// -----------------------------------
+    /// | cell     | size     | data      |
+    /// -----------------------------------
+    /// | uint16_t | uint32_t | uint8_t[] |
+    /// -----------------------------------
+    /// | 2        | 4        | size - 6  |
+    /// -----------------------------------
+    ///
+    /// \param path the path to the file, relative to the tilemaps directory
     /// \return a new game grid
+    /// \throw std::runtime_error if the file cannot be loaded
+    ///
+    /// \see Tilemap
     ///
     ////////////////////////////////////////////////////////////////////////////
     static std::unique_ptr<GameGrid> ReadFromFile(const std::string& path);
 
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  A factory function to create a game grid streamed from a file
+    ///
+    /// Only the chunks around the camera are kept in memory. The chunks within
+    /// STREAMING_LOAD_MARGIN chunks of the view are read from the file by the
+    /// thread pool, the closest first, so they are usually loaded before they
+    /// become visible. A chunk still being read is not drawn: the update never
+    /// waits for the file. The chunks farther than STREAMING_RELEASE_MARGIN
+    /// are released. While the memory budget is exceeded, the farthest chunks
+    /// outside of the load ring are released too, and only the visible chunks
+    /// are read. A chunk that cannot be read is requested again after
+    /// STREAMING_RETRY_DELAY seconds, the delay doubling after each failure up
+    /// to MAX_STREAMING_RETRY_DELAY.
+    ///
+    /// The budget only covers the loaded chunks. The movement masks and costs
+    /// of the tiles (about 1.25 bytes per tile) and the state of each chunk are
+    /// kept for the whole map, and a file of the version 1 is read once when it
+    /// is opened to index its chunks (see TilemapStream).
+    ///
+    /// The tiles of the chunks that are not loaded cannot be walked on nor
+    /// modified. A modified chunk is only released once it is saved, as it is
+    /// then read again from the journal. The grid can only be drawn in
+    /// RenderMode::Vertices.
+    ///
+    /// \param path the path to the file, relative to the tilemaps directory
+    /// \param memoryBudget the memory used by the loaded chunks (tiles and
+    ///        vertices), in bytes, which can be exceeded by the visible chunks
+    /// \return a new game grid
+    /// \throw std::runtime_error if the file cannot be opened
+    ///
+    /// \see ReadFromFile for the file format
+    /// \see TilemapStream
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    static std::unique_ptr<GameGrid> StreamFromFile(const std::string& path,
+                                                    uint64_t memoryBudget = DEFAULT_STREAMING_BUDGET);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Saves the chunks modified since the previous save
+    ///
+    /// The chunks are appended to the journal of the tilemap file, which is
+    /// synced to the disk before the function returns, so the cost of a save
+    /// depends on the number of modified chunks and not on the size of the
+    /// map. The saved chunks are loaded instead of the chunks of the file by
+    /// the next grids created from it: the tilemap is invalidated in the
+    /// TilemapRegistry, the grids using it keep their version. Only the first
+    /// grid created from a tilemap saves it: the journal is locked by its
+    /// writer, and the other grids cannot be saved (see CanSave).
+    ///
+    /// A save started by SaveAsync is finished first.
+    ///
+    /// \return the number of saved chunks
+    /// \throw std::runtime_error if the chunks cannot be written, they are
+    ///        then saved again by the next save, or if the grid cannot be
+    ///        saved
+    ///
+    /// \see TilemapJournal
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    uint32_t Save();
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Saves the chunks modified since the previous save in the
+    ///         background
+    ///
+    /// Only the pointers to the modified chunks are copied: a saved chunk is
+    /// shared with the save, and copied by its first modification until the
+    /// result of the save is applied (like the chunks shared with the
+    /// tilemap), so the game keeps modifying the grid
+    /// while the chunks are serialized, compressed and synced to the disk by
+    /// the thread pool. The result is applied by the first update after the
+    /// save is written, a chunk that failed to be saved is saved again by the
+    /// next save.
+    ///
+    /// \return false if the previous save is still being written or if the
+    ///         grid cannot be saved, nothing is saved then
+    ///
+    /// \see Save
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    bool SaveAsync();
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns true if a save is being written in the background
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] inline bool IsSaving() const { return m_saveTask != nullptr; }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns true if the grid writes the journal of its tilemap
+    ///
+    /// The journal of a tilemap is written by one grid at a time, the other
+    /// grids only read it and cannot be saved. The autosave is then disabled.
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] inline bool CanSave() const { return m_journal->IsWritable(); }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Sets the interval between two saves started by the updates
+    ///
+    /// \param interval the interval, in seconds, 0 to disable the autosave
+    ///
+    /// \see SaveAsync
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    inline void SetAutosaveInterval(float interval) { m_autosaveInterval = interval; }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Replaces a tile of the grid
+    ///
+    /// Only the vertices of the tile are sent to the GPU on the next update,
+    /// the modifications made during a frame are grouped in contiguous ranges.
+    /// This is meant for the frequent small changes of the map, like hoeing
+    /// and planting soil.
+    ///
+    /// The custom data has the format of the tile data section of the tilemap
+    /// files. A passage point requires its destination, a soil is empty
+    /// without data. The tile is left unchanged if the data is invalid.
+    ///
+    /// \param x the x coordinate of the tile
+    /// \param y the y coordinate of the tile
+    /// \param type the type of the new tile
+    /// \param textureIndex the texture index of the new tile
+    /// \param data the custom data of the new tile
+    /// \param size the size of the custom data
+    /// \return false if the custom data is invalid
+    /// \throw std::runtime_error if the type is unknown, or if the tile is not loaded
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    bool SetTile(uint32_t x, uint32_t y, TileType type, uint16_t textureIndex,
+                 const uint8_t* data = nullptr, uint32_t size = 0);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns true if the chunk containing a tile is in memory
+    ///
+    /// This is always true, unless the grid is streamed.
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] inline bool IsTileLoaded(uint32_t x, uint32_t y) const
+    {
+        return m_chunks[(y / CHUNK_SIZE) * m_chunkCountX + x / CHUNK_SIZE].state == ChunkState::Loaded;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the type of a tile
+    ///
+    /// \param x the x coordinate of the tile
+    /// \param y the y coordinate of the tile
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] inline TileType GetTileType(uint32_t x, uint32_t y) const
+    {
+        return GetChunk(x, y).types[TileChunk::GetCell(x, y)];
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the texture index of a tile
+    ///
+    /// \param x the x coordinate of the tile
+    /// \param y the y coordinate of the tile
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] inline uint16_t GetTextureIndex(uint32_t x, uint32_t y) const
+    {
+        return GetChunk(x, y).textureIndices[TileChunk::GetCell(x, y)];
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the movement flags of a tile
+    ///
+    /// \param x the x coordinate of the tile
+    /// \param y the y coordinate of the tile
+    /// \return a combination of the TileChunk::FLAG_* constants
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] inline uint8_t GetTileFlags(uint32_t x, uint32_t y) const
+    {
+        return GetChunk(x, y).flags[TileChunk::GetCell(x, y)];
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the data of a soil tile, to modify it
+    ///
+    /// The soil is registered in the active tiles, so that its changes
+    /// are simulated. The pointer is only valid until the next update or
+    /// save, as the chunk is copied if it is shared with a save.
+    ///
+    /// \param x the x coordinate of the tile
+    /// \param y the y coordinate of the tile
+    /// \return the data of the soil, or nullptr if the tile is not a soil
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    SoilData* GetSoil(uint32_t x, uint32_t y);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the destination of a passage point
+    ///
+    /// \param x the x coordinate of the tile
+    /// \param y the y coordinate of the tile
+    /// \return the destination, or nullptr if the tile is not a passage point
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] const PassagePointData* GetPassagePoint(uint32_t x, uint32_t y) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns true if the destination of passage points is in memory
+    ///
+    /// The tilemaps and tilesets of the passage points within
+    /// PASSAGE_PREFETCH_DISTANCE tiles of the camera are loaded by the thread
+    /// pool, and kept while the camera stays close to them. Once loaded,
+    /// ReadFromFile creates the grid of the destination from the registries,
+    /// without reading any file.
+    ///
+    /// \param tilemap the tilemap of the destination, relative to the tilemaps
+    ///        directory
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] bool IsDestinationLoaded(const std::string& tilemap) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the passage points of a chunk with their destinations
+    ///
+    /// \param chunkIndex the index of the chunk (chunkY * chunk count x + chunkX),
+    ///        which must be loaded
+    /// \param passagePoints receives the position and the destination of each
+    ///        passage point (it is cleared first)
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void GetPassagePoints(uint32_t chunkIndex, std::vector<std::pair<sf::Vector2u, PassagePointData>>& passagePoints) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns true if a tile can be walked on
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] inline bool IsWalkable(uint32_t x, uint32_t y) const { return m_walkableTiles.Get(x, y); }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the cost of walking on a tile
+    ///
+    /// \return MOVEMENT_COST_FAST, MOVEMENT_COST_NORMAL or MOVEMENT_COST_SLOW,
+    ///         or 0 if the tile cannot be walked on
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] inline uint8_t GetMovementCost(uint32_t x, uint32_t y) const
+    {
+        return m_movementCosts[static_cast<size_t>(y) * m_width + x];
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns true if every tile of a rectangle can be walked on
+    ///
+    /// The rectangle is clipped to the grid.
+    ///
+    /// \param x the x coordinate of the first tile
+    /// \param y the y coordinate of the first tile
+    /// \param width the width of the rectangle, in tiles
+    /// \param height the height of the rectangle, in tiles
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] bool IsAreaWalkable(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the number of tiles of a rectangle that can be planted
+    ///
+    /// \see IsAreaWalkable
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] uint64_t CountPlantableTiles(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const;
+
+    [[nodiscard]] inline const Bitboard& GetWalkableTiles() const { return m_walkableTiles; }
+    [[nodiscard]] inline const Bitboard& GetPlantableTiles() const { return m_plantableTiles; }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the movement costs of the tiles, indexed by y * width + x
+    ///
+    /// \see GetMovementCost
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] inline const std::vector<uint8_t>& GetMovementCosts() const { return m_movementCosts; }
+
+    [[nodiscard]] inline uint32_t GetWidth() const { return m_width; }
+    [[nodiscard]] inline uint32_t GetHeight() const { return m_height; }
+    [[nodiscard]] inline uint32_t GetChunkCountX() const { return m_chunkCountX; }
+    [[nodiscard]] inline uint32_t GetChunkCountY() const { return m_chunkCountY; }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns a counter incremented when a tile of a chunk is replaced
+    ///
+    /// The data derived from the movement costs of a chunk, like the graph of
+    /// the HierarchicalPathfinder, only needs to be updated when it changes.
+    /// Loading or unloading a streamed chunk does not change it, the tiles of
+    /// the chunk stay the same.
+    ///
+    /// \param chunkIndex the index of the chunk (chunkY * chunk count x + chunkX)
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] inline uint32_t GetChunkVersion(uint32_t chunkIndex) const { return m_chunkVersions[chunkIndex]; }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns a counter incremented when a tile is replaced or a
+    ///         streamed chunk is loaded or unloaded
+    ///
+    /// The movement costs of the grid did not change while it stays the same,
+    /// so the data derived from them does not need to be checked chunk by
+    /// chunk (see GetChunkVersion).
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] inline uint64_t GetVersion() const { return m_version; }
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the number of tiles updated by the grid
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] inline uint64_t GetActiveTileCount() const { return m_scheduler.GetActiveTileCount(); }
+
+    static constexpr float TILE_SIZE = 32.0f;
+    static constexpr uint32_t CHUNK_SIZE = TileChunk::SIZE;
+
+    // The cost of walking on a tile, depending on its movement flags
+    static constexpr uint8_t MOVEMENT_COST_FAST = 2;
+    static constexpr uint8_t MOVEMENT_COST_NORMAL = 3;
+    static constexpr uint8_t MOVEMENT_COST_SLOW = 5;
+
+    // The number of unmodified tiles that can be sent again to merge two
+    // ranges of modified tiles in a single upload
+    static constexpr uint32_t MAX_PATCH_GAP = 8;
+
+    // The number of chunks whose vertices are created before being uploaded,
+    // which bounds the memory used by a full rebuild
+    static constexpr uint32_t REBUILD_BATCH_SIZE = 64;
+
+    // The distances from the view, in chunks, within which the chunks of a
+    // streamed grid are loaded, and beyond which they are released
+    static constexpr uint32_t STREAMING_LOAD_MARGIN = 2;
+    static constexpr uint32_t STREAMING_RELEASE_MARGIN = 4;
+
+    // The number of chunks of a streamed grid being read at the same time
+    static constexpr uint32_t MAX_STREAMING_LOADS = 16;
+
+    // The delays in seconds before a chunk that could not be read is requested
+    // again, after the first failure and at most
+    static constexpr float STREAMING_RETRY_DELAY = 1.0f;
+    static constexpr float MAX_STREAMING_RETRY_DELAY = 64.0f;
+
+    static constexpr uint64_t DEFAULT_STREAMING_BUDGET = 256 * 1024 * 1024;
+
+    // The distance from the camera, in tiles, within which the destinations
+    // of the passage points are loaded in the background
+    static constexpr uint32_t PASSAGE_PREFETCH_DISTANCE = 48;
+
 private:
-// We need to pack the structures to tell to the compiler to not add any padding
-#pragma pack(push, 1)
-    // The header of the file
-    struct RawGameGrid
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Creates a game grid from a tilemap
+    ///
+    /// \param tilemap a handle to the tilemap of the grid
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    explicit GameGrid(TilemapRegistry::ResourceHandle&& tilemap);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Creates a streamed game grid, without any chunk loaded
+    ///
+    /// \param stream the file of the grid
+    /// \param memoryBudget the memory used by the loaded chunks, in bytes
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    GameGrid(std::shared_ptr<TilemapStream> stream, uint64_t memoryBudget);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Sets up the chunks, the tileset and the masks of an empty grid
+    ///
+    /// \param width the width of the grid, in tiles
+    /// \param height the height of the grid, in tiles
+    /// \param tilesetPath the path to the tileset
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void Initialize(uint32_t width, uint32_t height, const std::string& tilesetPath);
+
+    enum class ChunkState : uint8_t
+    {
+        Loaded,
+        Unloaded,
+        Loading,
+        // The chunk could not be read, it is requested again after its retry delay
+        Failed
+    };
+
+    // A square of CHUNK_SIZE x CHUNK_SIZE tiles with its own geometry
+    // (the chunks on the right and bottom edges may be smaller)
+    struct Chunk
+    {
+        // The geometry is static, it is only uploaded when a tile changes
+        sf::VertexBuffer vertexBuffer{sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Static};
+
+        // Used instead of the vertex buffer when vertex buffers are not
+        // supported, the vertices are then sent at every draw
+        sf::VertexArray vertexArray{sf::PrimitiveType::Triangles};
+
+        // True if the whole chunk needs to be rebuilt
+        bool dirty = false;
+
+        // The tiles whose vertices need to be sent again, as indices in the chunk
+        std::vector<uint32_t> dirtyTiles;
+
+        // Only a streamed grid has chunks that are not loaded
+        ChunkState state = ChunkState::Loaded;
+
+        // True if the tiles differ from the file and its journal
+        bool modified = false;
+
+        // True if the tiles are being written by a save, the chunk cannot be
+        // released before the save is done
+        bool saving = false;
+
+        // Only for the chunks that could not be read: the time before the chunk
+        // is requested again, and the delay doubled after each failure
+        float retryTimer = 0.f;
+        float retryDelay = 0.f;
+    };
+
+    // The result of a save written by the thread pool, shared with the task
+    struct SaveTask
     {
-        uint32_t width;
-        uint32_t height;
-        uint32_t tilesetPathSize; // size of the tilemaps path
-        uint32_t tilesSize; // total size of tiles
-        uint32_t entitiesSize; // total size of entities
-        uint8_t data[];
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool finished = false;
+        bool saved = false;
     };
 
-    // The tile structure in the file
-    struct RawGameTile
+    // The chunks read by the thread pool, shared with the loading tasks
+    struct StreamedChunks
     {
-        TileType type;
-        uint32_t size; // size of total structure
-        uint32_t textureIndex; // offset in texture names
-        uint8_t data[]; // custom data
+        std::mutex mutex;
+        std::vector<std::pair<uint32_t, std::shared_ptr<TileChunk>>> chunks;
     };
 
-    // The entity structure in the file (TODO)
-    struct RawGameEntity
+    // The resources of a destination of the passage points
+    struct Destination
     {
-        uint32_t size; // size of total structure
-        uint32_t textureIndex; // offset in texture names
-        uint8_t data[]; // custom data
+        TilemapRegistry::ResourceHandle tilemap;
+        TilesetRegistry::ResourceHandle tileset;
+
+        // Both are false while the destination is loading
+        bool loaded = false;
+        bool failed = false;
+    };
+
+    // The destinations loaded by the thread pool, shared with the loading tasks
+    struct LoadedDestinations
+    {
+        std::mutex mutex;
+        std::vector<std::pair<std::string, Destination>> destinations;
+    };
+
+    // A rectangle of chunks, from the first to the last included, empty if
+    // the first is after the last
+    struct ChunkArea
+    {
+        int64_t firstX;
+        int64_t firstY;
+        int64_t lastX;
+        int64_t lastY;
     };
-#pragma pack(pop)
 
-public:
     ////////////////////////////////////////////////////////////////////////////
-    /// \brief  A class representing a tile
+    /// \brief  Returns the chunk containing a tile
     ///
-    /// This class is the base class for all tiles. It is responsible for
-    /// the texture index of the tile, and the parsing of the raw tile
-    /// structure.
-    ///
-    /// \see Tile::ParseRawTile
     ////////////////////////////////////////////////////////////////////////////
-    class Tile
+    [[nodiscard]] inline const TileChunk& GetChunk(uint32_t x, uint32_t y) const
     {
-    public:
-        explicit Tile(uint64_t textureIndex) : m_textureIndex(textureIndex) {}
-        Tile(const Tile& other) = delete;
-        Tile& operator=(const Tile& other) = delete;
-
-        virtual ~Tile() = default;
-
-        virtual void Update(float deltaTime) = 0;
-    protected:
-        friend GameGrid;
-
-        ////////////////////////////////////////////////////////////////////////////
-        /// \brief  A factory function to create a tile from a the raw tile structure
-        ///
-        /// \param rawTile the raw tile structure
-        /// \return A new tile subclass
-        ///
-        ////////////////////////////////////////////////////////////////////////////
-        static std::unique_ptr<Tile> ParseRawTile(RawGameTile* rawTile);
-
-    private:
-        uint64_t m_textureIndex;
-    };
+        return *m_tileChunks[(y / CHUNK_SIZE) * m_chunkCountX + x / CHUNK_SIZE];
+    }
 
-    static constexpr float TILE_SIZE = 32.0f;
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the chunk containing a tile, to modify it
+    ///
+    /// If the chunk is shared with the tilemap, another grid or a save, it
+    /// is copied first. A chunk being saved is copied by its first
+    /// modification until FinishSave, even if the save already released it.
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    TileChunk& GetMutableChunk(uint32_t x, uint32_t y);
 
-private:
     ////////////////////////////////////////////////////////////////////////////
-    /// \brief  Creates a game grid from the tilemap and the tileset
+    /// \brief  Updates the walkability, the movement cost and the
+    ///         plantability of a tile from its flags and type
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void UpdateTileMasks(uint32_t x, uint32_t y);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Updates the masks of the tiles of a chunk and registers its
+    ///         active tiles, after it was loaded
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void AddChunkTiles(uint32_t chunkIndex);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Clears the masks of the tiles of a chunk and unregisters its
+    ///         active tiles, before it is released
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void RemoveChunkTiles(uint32_t chunkIndex);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Loads and releases the chunks of a streamed grid around the view
+    ///
+    /// The chunks read since the last update are added to the grid, the
+    /// missing chunks around the view are requested, and the chunks far from
+    /// the view are released. The chunks that could not be read are requested
+    /// again once their retry delay is elapsed.
+    ///
+    /// \param deltaTime the time since the last update, in seconds
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void UpdateStreaming(float deltaTime);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Releases the tiles and the vertices of a chunk
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void ReleaseChunk(uint32_t chunkIndex);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Loads the destinations of the passage points near the camera,
+    ///         and releases the others
+    ///
+    /// The resources of a released destination stay cached in the registries
+    /// until their budget is exceeded.
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void UpdateDestinations();
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Applies the result of the background save once it is written,
+    ///         and starts the autosave
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void UpdateSave(float deltaTime);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Shares the modified chunks with a new save
+    ///
+    /// \return the chunks to save
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    std::vector<TilemapJournal::SavedChunk> TakeSnapshot();
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Marks the chunks of the snapshot as saved, or as modified again
+    ///         if the save failed
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void FinishSave(bool saved);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the point of the grid at the center of the window, in tiles
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] sf::Vector2f GetCameraCenter() const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the transform from the grid to the window
+    ///
+    /// It depends on the camera position and zoom factor.
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] sf::Transform GetCameraTransform() const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Returns the chunks seen by the camera
+    ///
+    /// \param transform the camera transform
+    /// \return the chunks intersecting the window, clipped to the grid
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    [[nodiscard]] ChunkArea GetVisibleChunks(const sf::Transform& transform) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Updates the active tiles with the systems of their types
+    ///
+    /// \param deltaTime the time since the last frame
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void UpdateTiles(float deltaTime);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Marks a tile as dirty
+    ///
+    /// Its vertices are sent to the GPU on the next update.
+    ///
+    /// \param x the x coordinate of the tile
+    /// \param y the y coordinate of the tile
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void MarkTileDirty(uint32_t x, uint32_t y);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Creates the vertices of a chunk
+    ///
+    /// This function needs to be called when a tile of the chunk is modified,
+    /// it will rebuild the vertices of the chunk. It only reads the grid, so
+    /// several chunks can be built at the same time.
+    ///
+    /// \param chunkX the x coordinate of the chunk, in chunks
+    /// \param chunkY the y coordinate of the chunk, in chunks
+    /// \param vertices the list receiving the vertices (it is cleared first)
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void CreateChunkVertices(uint32_t chunkX, uint32_t chunkY, std::vector<sf::Vertex>& vertices) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Writes the 6 vertices of a tile
+    ///
+    /// \param x the x coordinate of the tile
+    /// \param y the y coordinate of the tile
+    /// \param vertices where the vertices are written
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void WriteTileVertices(uint32_t x, uint32_t y, sf::Vertex* vertices) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Sends the vertices of the dirty tiles of a chunk to the GPU
+    ///
+    /// \param chunkIndex the index of the chunk
+    /// \param vertices a list used to store the vertices before the upload
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void PatchChunk(uint32_t chunkIndex, std::vector<sf::Vertex>& vertices);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Sends the vertices of a chunk to its vertex buffer
+    ///
+    /// \param chunk the chunk to update
+    /// \param vertices the vertices of the chunk
+    ///
+    ////////////////////////////////////////////////////////////////////////////
+    void UploadChunk(Chunk& chunk, const std::vector<sf::Vertex>& vertices);
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Applies the requested render mode
     ///
-    /// \param tiles the tilemap of the grid
-    /// \param tileset the tileset used by the tilemap
-    /// \param width the width of the grid
-    /// \param height the height of the grid
+    /// Every chunk is marked as dirty, so that it is sent again in the new mode.
     ///
     ////////////////////////////////////////////////////////////////////////////
-    explicit GameGrid(std::vector<std::unique_ptr<Tile>>&& tiles, const std::string& tileset, int width, int height);
+    void SwitchRenderMode();
 
     ////////////////////////////////////////////////////////////////////////////
-    /// \brief  Creates a vertex array from the tilemap
+    /// \brief  Creates the tile indices texture and the shader
+    ///
+    /// \return true if the grid can be drawn with the shader, false otherwise
     ///
-    /// This function needs to be called when the tilemap is modified, it will
-    /// rebuild the vertex array.
+    ////////////////////////////////////////////////////////////////////////////
+    bool PrepareShaderRenderer();
+
+    ////////////////////////////////////////////////////////////////////////////
+    /// \brief  Sends the texture indices of a rectangle of tiles to the GPU
     ///
-    /// \return a vertex array
+    /// An index is stored in the red and green channels of a texel (least
+    /// significant byte first), like the 16 bits indices of the chunks.
+    ///
+    /// \param firstX the x coordinate of the first tile
+    /// \param firstY the y coordinate of the first tile
+    /// \param width the width of the rectangle, in tiles
+    /// \param height the height of the rectangle, in tiles
     ///
     ////////////////////////////////////////////////////////////////////////////
-    sf::VertexArray CreateVertexArray();
+    void UploadTileIndices(uint32_t firstX, uint32_t firstY, uint32_t width, uint32_t height);
+
+    // The shared, read-only tilemap, and its path relative to TilemapPath
+    TilemapRegistry::ResourceHandle m_tilemap;
+    std::string m_path;
+
+    // The saves of the tilemap, and the chunks modified since the last one
+    std::shared_ptr<TilemapJournal> m_journal;
+    std::vector<uint32_t> m_modifiedChunks;
+
+    // The save being written by the thread pool, and its chunks
+    std::shared_ptr<SaveTask> m_saveTask;
+    std::vector<uint32_t> m_savingChunks;
+    float m_autosaveInterval = 0.f;
+    float m_autosaveTimer = 0.f;
+
+    // The state of the tiles, indexed like m_chunks
+    std::vector<std::shared_ptr<TileChunk>> m_tileChunks;
 
+    // Derived from the tiles, and updated when a tile is replaced
+    Bitboard m_walkableTiles;
+    Bitboard m_plantableTiles;
+    std::vector<uint8_t> m_movementCosts;
+    std::vector<uint32_t> m_chunkVersions;
+    uint64_t m_version = 0;
 
-    std::vector<std::unique_ptr<Tile>> m_tiles;
+    // Only set if the grid is streamed
+    std::shared_ptr<TilemapStream> m_stream;
+    std::shared_ptr<StreamedChunks> m_streamedChunks;
 
-    TextureRegistry::ResourceHandle m_tilesetTexture;
+    // Shared by the chunks that are not loaded
+    std::shared_ptr<TileChunk> m_unloadedChunk;
 
-    sf::VertexArray m_vertexArray;
-    std::atomic_bool m_shouldUpdateVertexArray = true;
-    std::mutex m_vertexArrayMutex;
+    std::vector<uint32_t> m_loadedChunks;
+    uint32_t m_loadingChunkCount = 0;
+    std::vector<uint32_t> m_failedChunks;
+    uint64_t m_streamingBudget = 0;
+
+    // The memory used by the tiles of the loaded chunks, in bytes
+    uint64_t m_loadedTileSize = 0;
+
+    // The destinations of the passage points near the camera, by tilemap
+    std::unordered_map<std::string, Destination> m_destinations;
+    std::shared_ptr<LoadedDestinations> m_loadedDestinations = std::make_shared<LoadedDestinations>();
+
+    // The tiles that need to be updated
+    TileScheduler m_scheduler;
+    std::vector<SoilData*> m_soilBatch;
+
+    TilesetRegistry::ResourceHandle m_tileset;
+
+    // The chunks, indexed by chunkY * m_chunkCountX + chunkX
+    std::vector<Chunk> m_chunks;
+    std::vector<uint32_t> m_dirtyChunks;
+    std::vector<uint32_t> m_patchedChunks;
+
+    // The vertices of the chunks being rebuilt, kept to avoid reallocations
+    std::vector<std::vector<sf::Vertex>> m_chunkVertices;
+    std::mutex m_chunksMutex;
+
+    // Checked once, as it does not change while the game runs
+    bool m_useVertexBuffers;
+
+    // The memory used by the vertices of the chunks, in bytes
+    uint64_t m_geometrySize = 0;
+
+    RenderMode m_renderMode = RenderMode::Vertices;
+    RenderMode m_requestedRenderMode = RenderMode::Vertices;
+
+    // Only created in RenderMode::Shader
+    std::unique_ptr<sf::Texture> m_tileIndices;
+    std::unique_ptr<sf::Shader> m_tilemapShader;
+    std::vector<uint8_t> m_tileIndexPixels;
 
     uint32_t m_width;
     uint32_t m_height;
+    uint32_t m_chunkCountX;
+    uint32_t m_chunkCountY;
 
     sf::Vector2f m_cameraPosition = {0, 0};
     float m_zoomFactor = 1.0f;
+
+    RenderStatistics m_renderStatistics;
 };
\ No newline at end of file
@@ -0,0 +1,249 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "Pathfinder.h"
+#include "TileChunk.h"
+
+class GameGrid;
+
+////////////////////////////////////////////////////////////
+/// \brief  Finds long paths on a grid with an abstract graph
+///
+/// The grid is split in clusters, the chunks of the grid. Where
+/// two neighbor clusters can be crossed, each run of walkable
+/// tiles along their border is an entrance, and the tiles of the
+/// entrance in the middle of the run are the nodes of an abstract
+/// graph. The nodes of a cluster are linked by the cost of the
+/// cheapest path between them inside of the cluster, computed
+/// when the graph is built, so a query searches a few nodes per
+/// cluster instead of every tile, and only the steps of the
+/// abstract path are refined with the Pathfinder.
+///
+/// The paths are close to the cheapest, but not always the
+/// cheapest: they go through the middle of the entrances. The
+/// short queries (inside of a cluster or between close tiles)
+/// use the Pathfinder directly.
+///
+/// The graph is kept up to date by Refresh: only the clusters
+/// containing replaced tiles and the neighbors sharing a modified
+/// border are computed again. The edges are not stored, a query
+/// reads them from the costs and the entrances of the clusters.
+///
+/// On a streamed grid, a cluster is computed once it and its
+/// neighbors are loaded, and is kept when its chunk is unloaded
+/// (its tiles do not change). The unloaded chunks cannot be
+/// entered by the paths.
+///
+/// The passage points of the grids are links between the graphs
+/// of several maps, used by FindRoute to find routes across the
+/// maps.
+///
+////////////////////////////////////////////////////////////
+class HierarchicalPathfinder
+{
+public:
+    // The part of a route inside of one map
+    struct RouteLeg
+    {
+        std::string tilemap;
+        std::vector<sf::Vector2u> path;
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Creates the abstract graph of a grid
+    ///
+    /// The grid must outlive the pathfinder.
+    ///
+    /// \param grid the grid
+    ///
+    ////////////////////////////////////////////////////////////
+    explicit HierarchicalPathfinder(const GameGrid& grid);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Updates the graph after tiles of the grid were replaced,
+    ///         or chunks were loaded for the first time
+    ///
+    /// It must not be called during a query. Nothing changed while
+    /// GameGrid::GetVersion stays the same, so it only needs to be called
+    /// when it changed.
+    ///
+    ////////////////////////////////////////////////////////////
+    void Refresh();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Finds a path between two tiles
+    ///
+    /// Several queries can run at the same time.
+    ///
+    /// \param start the first tile
+    /// \param goal the last tile
+    /// \param path receives the tiles of the path, from start to goal
+    ///        (it is cleared first)
+    /// \return false if there is no path
+    ///
+    /// \see Pathfinder::FindPath
+    ///
+    ////////////////////////////////////////////////////////////
+    bool FindPath(sf::Vector2u start, sf::Vector2u goal, std::vector<sf::Vector2u>& path) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the cost of the path between two tiles
+    ///
+    /// Only the abstract graph is searched, the path is not refined.
+    ///
+    /// \param start the first tile
+    /// \param goal the last tile
+    /// \param cost receives the cost of the path
+    /// \return false if there is no path
+    ///
+    ////////////////////////////////////////////////////////////
+    bool FindCost(sf::Vector2u start, sf::Vector2u goal, uint32_t& cost) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Finds a route across several maps
+    ///
+    /// A route goes from a map to another by walking on a passage point,
+    /// which moves to its destination. The passage points leading to a map
+    /// missing from the list are ignored.
+    ///
+    /// \param maps the pathfinder of each map, by tilemap path (the
+    ///        destination of the passage points)
+    /// \param startTilemap the map of the first tile
+    /// \param start the first tile
+    /// \param goalTilemap the map of the last tile
+    /// \param goal the last tile
+    /// \param route receives the path in each map, in order (it is cleared
+    ///        first), each leg but the last ending on a passage point
+    /// \return false if there is no route
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool FindRoute(const std::unordered_map<std::string, const HierarchicalPathfinder*>& maps,
+                          const std::string& startTilemap, sf::Vector2u start,
+                          const std::string& goalTilemap, sf::Vector2u goal,
+                          std::vector<RouteLeg>& route);
+
+    [[nodiscard]] inline uint32_t GetNodeCount() const { return static_cast<uint32_t>(m_nodeClusters.size()); }
+
+    static constexpr uint32_t CLUSTER_SIZE = TileChunk::SIZE;
+
+private:
+    struct Cluster
+    {
+        // The version of the chunk of the grid when the cluster was computed
+        uint32_t version = UINT32_MAX;
+
+        // The entrances on the right and bottom borders, as the y (right) or
+        // x (bottom) coordinate of their tiles
+        std::vector<uint32_t> rightEntrances;
+        std::vector<uint32_t> bottomEntrances;
+
+        // The nodes of the cluster, as tile indices (y * width + x) in order
+        std::vector<uint32_t> nodes;
+
+        // The cost from each node to each other (nodes.size() x nodes.size()),
+        // UINT32_MAX if it cannot be reached inside of the cluster
+        std::vector<uint32_t> costs;
+
+        // The id of the first node of the cluster, the ids of its nodes follow
+        uint32_t firstNode = 0;
+
+        // The passage points of the cluster and their destinations
+        std::vector<std::pair<sf::Vector2u, PassagePointData>> passagePoints;
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns true if the chunk of a cluster and the chunks of
+    ///         its neighbors are loaded
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] bool IsClusterLoaded(uint32_t clusterIndex) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Finds the entrances on the right or bottom border of a cluster
+    ///
+    /// \param clusterIndex the index of the cluster
+    /// \param right true for the right border, false for the bottom border
+    /// \return true if the entrances changed
+    ///
+    ////////////////////////////////////////////////////////////
+    bool UpdateEntrances(uint32_t clusterIndex, bool right);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Gathers the nodes of a cluster and computes the costs between them
+    ///
+    ////////////////////////////////////////////////////////////
+    void UpdateCluster(uint32_t clusterIndex);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Numbers the nodes of every cluster, after the number of
+    ///         nodes of a cluster changed
+    ///
+    ////////////////////////////////////////////////////////////
+    void NumberNodes();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the id of the node of a cluster on a tile, or
+    ///         UINT32_MAX if the tile is not a node
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] uint32_t FindNode(uint32_t clusterIndex, uint32_t tile) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Computes the cost of the paths inside of a cluster from a tile
+    ///
+    /// \param clusterIndex the index of the cluster
+    /// \param source the tile the paths start from (or end at if reverse is true)
+    /// \param reverse true to compute the costs to the source instead
+    /// \param costs receives the cost of each tile of the cluster, indexed by
+    ///        (y % CLUSTER_SIZE) * CLUSTER_SIZE + x % CLUSTER_SIZE, UINT32_MAX
+    ///        if it cannot be reached
+    ///
+    ////////////////////////////////////////////////////////////
+    void SearchCluster(uint32_t clusterIndex, uint32_t source, bool reverse, std::vector<uint32_t>& costs) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Searches the abstract graph
+    ///
+    /// \param start the first tile
+    /// \param goal the last tile
+    /// \param nodes receives the tiles of the nodes on the path, without
+    ///        the start and the goal (it is cleared first)
+    /// \param cost receives the cost of the path
+    /// \return false if there is no path
+    ///
+    ////////////////////////////////////////////////////////////
+    bool SearchGraph(sf::Vector2u start, sf::Vector2u goal, std::vector<uint32_t>& nodes, uint32_t& cost) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns true if a query is short enough for the Pathfinder
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] bool IsShortQuery(sf::Vector2u start, sf::Vector2u goal) const;
+
+    [[nodiscard]] inline uint32_t GetClusterIndex(uint32_t x, uint32_t y) const
+    {
+        return (y / CLUSTER_SIZE) * m_clusterCountX + x / CLUSTER_SIZE;
+    }
+
+    const GameGrid& m_grid;
+    const std::vector<uint8_t>& m_costs;
+    Pathfinder m_pathfinder;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_clusterCountX;
+    uint32_t m_clusterCountY;
+
+    std::vector<Cluster> m_clusters;
+
+    // The cluster of each node, by id
+    std::vector<uint32_t> m_nodeClusters;
+};
@@ -8,6 +8,10 @@
 #include <queue>
 #include "ResourceRegistry.h"
 #include "GameGrid.h"
+#include "HierarchicalPathfinder.h"
+#include "FlowFieldCache.h"
+#include "TextureAtlas.h"
+#include "SpriteBatch.h"
 
 // A temporary scene
 
@@ -23,20 +27,45 @@ public:
     void HandleEvent(const sf::Event& event) override;
 
 private:
+    // The interval between two saves of the grid, in seconds. F5 saves it
+    // as well, and it is saved when the scene is destroyed
+    static constexpr float AUTOSAVE_INTERVAL = 60.0f;
+
     std::atomic_bool m_loaded = false;
 
     TextureRegistry::ResourceHandle m_loadingScreenTexture;
     sf::Sprite m_loadingScreenSprite;
 
-    TextureRegistry::ResourceHandle m_mainMenuTexture;
+    TextureAtlas::Region m_mainMenuRegion;
     sf::Sprite m_mainMenuSprite;
+    SpriteBatch m_spriteBatch;
 
     std::unique_ptr<GameGrid> m_testGameGrid;
 
+#ifdef DEBUG
+    // Finds the paths between the clicked tiles, and the flow fields to the
+    // right clicked tiles, until there are units to move
+    std::unique_ptr<HierarchicalPathfinder> m_pathfinder;
+    std::unique_ptr<FlowFieldCache> m_flowFields;
+    uint64_t m_pathfinderVersion = UINT64_MAX;
+    sf::Vector2u m_pathStart;
+    std::vector<sf::Vector2u> m_path;
+#endif
+
     sf::Vector2f m_cameraMovement;
     sf::Vector2f m_pos;
     float m_zoomDelta = 0.0f;
     float m_zoom = 1.0f;
 
+#ifdef DEBUG
+    // Used to log the render statistics of the grid every second
+    float m_statisticsTimer = 0.0f;
+    uint32_t m_statisticsFrameCount = 0;
+
+    // The render benchmark needs the window, it runs in the next Render
+    static constexpr uint32_t RENDER_BENCHMARK_FRAMES = 200;
+    bool m_renderBenchmarkRequested = false;
+#endif
+
     std::queue<std::exception_ptr> m_exceptions;
 };
\ No newline at end of file
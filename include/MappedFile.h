@@ -0,0 +1,105 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+////////////////////////////////////////////////////////////
+/// \brief  A read-only file mapped in memory
+///
+/// The content of the file is read by the system when its pages
+/// are first accessed, without being copied in a buffer of the
+/// process, and the pages can be dropped again under memory
+/// pressure. The file is unmapped when the object is destroyed
+/// or closed.
+///
+/// The content is only accessed through GetRange and Read, which
+/// check that the requested bytes are inside of the file.
+///
+////////////////////////////////////////////////////////////
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Maps a file, the previous one is unmapped
+    ///
+    /// \param path the path to the file
+    /// \return true if the file was mapped, false if it cannot be
+    ///         opened or is empty
+    ///
+    ////////////////////////////////////////////////////////////
+    bool Open(const std::string& path);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Unmaps the file
+    ///
+    /// The pointers returned by GetRange are no longer valid.
+    ///
+    ////////////////////////////////////////////////////////////
+    void Close();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns a range of bytes of the file
+    ///
+    /// \param offset the offset of the range in the file
+    /// \param size the size of the range
+    /// \return the first byte of the range, or nullptr if the range is
+    ///         not inside of the file
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline const uint8_t* GetRange(uint64_t offset, uint64_t size) const
+    {
+        if(offset > m_size || size > m_size - offset)
+        {
+            return nullptr;
+        }
+
+        return m_data + offset;
+    }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Copies a structure from the file
+    ///
+    /// The structure does not need to be aligned in the file.
+    ///
+    /// \param offset the offset of the structure in the file
+    /// \param value the structure to fill
+    /// \return false if the structure is not inside of the file
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    bool Read(uint64_t offset, T& value) const
+    {
+        const uint8_t* bytes = GetRange(offset, sizeof(T));
+        if(bytes == nullptr)
+        {
+            return false;
+        }
+
+        std::memcpy(&value, bytes, sizeof(T));
+        return true;
+    }
+
+    [[nodiscard]] inline bool IsOpen() const { return m_data != nullptr; }
+    [[nodiscard]] inline uint64_t GetSize() const { return m_size; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    uint64_t m_size = 0;
+
+#ifdef _WIN32
+    void* m_mapping = nullptr;
+#endif
+};
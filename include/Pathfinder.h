@@ -0,0 +1,135 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+
+class GameGrid;
+class ThreadPool;
+
+////////////////////////////////////////////////////////////
+/// \brief  Finds paths for the NPCs on a grid of movement costs
+///
+/// The paths are found with A*, moving in 4 directions, the cost
+/// of a step being the movement cost of the tile entered (see
+/// GameGrid::GetMovementCost). As paths are cheaper than the other
+/// tiles, the NPCs prefer them when the detour is short enough.
+/// The heuristic assumes that no tile is cheaper than
+/// GameGrid::MOVEMENT_COST_FAST.
+///
+/// Jump point search is not used: it only prunes grids where every
+/// walkable tile has the same cost.
+///
+/// The movement costs are small integers, so the open list is a
+/// ring of buckets indexed by estimated cost rather than a heap.
+/// The search states are kept by the pathfinder between the
+/// queries, one per query running at the same time, and reset in
+/// constant time with a generation counter, so a query does not
+/// allocate once there are enough states. They cover the whole
+/// grid (16 bytes per tile) and are released with the pathfinder.
+/// Several queries can run at the same time, but the costs must
+/// not be modified during a query.
+///
+////////////////////////////////////////////////////////////
+class Pathfinder
+{
+public:
+    // The largest distance between the start and the goal of the local queries of Benchmark
+    static constexpr uint32_t LOCAL_DISTANCE = 64;
+
+    // A query of FindPaths
+    struct Request
+    {
+        sf::Vector2u start;
+        sf::Vector2u goal;
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Creates a pathfinder over a grid of movement costs
+    ///
+    /// The costs are not copied, they must outlive the pathfinder.
+    ///
+    /// \param costs the cost of each tile (y * width + x), 0 if it
+    ///        cannot be walked on
+    /// \param width the width of the grid
+    /// \param height the height of the grid
+    ///
+    ////////////////////////////////////////////////////////////
+    Pathfinder(const std::vector<uint8_t>& costs, uint32_t width, uint32_t height);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Creates a pathfinder over the tiles of a grid
+    ///
+    ////////////////////////////////////////////////////////////
+    explicit Pathfinder(const GameGrid& grid);
+
+    ~Pathfinder();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Finds the cheapest path between two tiles
+    ///
+    /// \param start the first tile
+    /// \param goal the last tile
+    /// \param path receives the tiles of the path, from start to goal
+    ///        (it is cleared first)
+    /// \return false if there is no path, or if the start or the goal
+    ///         cannot be walked on
+    ///
+    ////////////////////////////////////////////////////////////
+    bool FindPath(sf::Vector2u start, sf::Vector2u goal, std::vector<sf::Vector2u>& path) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Finds several paths in parallel
+    ///
+    /// The calling thread takes part in the queries.
+    ///
+    /// \param requests the queries
+    /// \param paths receives the path of each query, empty if there is no path
+    ///        (the lists are reused, so keeping them avoids allocations)
+    /// \param threadPool the threads running the queries
+    /// \return the number of threads which ran queries
+    ///
+    ////////////////////////////////////////////////////////////
+    size_t FindPaths(const std::vector<Request>& requests, std::vector<std::vector<sf::Vector2u>>& paths,
+                     ThreadPool& threadPool) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Measures the throughput of the pathfinder and logs it
+    ///
+    /// Random queries are run on a random grid with walls, paths and
+    /// soils, on one thread, then on the whole thread pool. The queries
+    /// across the whole grid visit most of its tiles, so they are
+    /// measured apart from the local queries (the goal at most
+    /// LOCAL_DISTANCE tiles away on each axis), the usual queries of
+    /// the NPCs.
+    ///
+    /// \param threadPool the threads running the queries
+    /// \param size the width and height of the grid
+    /// \param requestCount the number of queries
+    ///
+    ////////////////////////////////////////////////////////////
+    static void Benchmark(ThreadPool& threadPool, uint32_t size, uint32_t requestCount);
+
+private:
+    struct SearchState;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Runs a query with the given search state
+    ///
+    ////////////////////////////////////////////////////////////
+    bool FindPath(SearchState& state, sf::Vector2u start, sf::Vector2u goal, std::vector<sf::Vector2u>& path) const;
+
+    const std::vector<uint8_t>& m_costs;
+    uint32_t m_width;
+    uint32_t m_height;
+
+    // The search states not used by a query
+    mutable std::mutex m_searchStatesMutex;
+    mutable std::vector<std::unique_ptr<SearchState>> m_searchStates;
+};
@@ -4,37 +4,226 @@
 
 #pragma once
 
-#include <unordered_set>
+#include <unordered_map>
+#include <list>
 #include <mutex>
+#include <string>
+#include <vector>
 #include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Shader.hpp>
+#include <SFML/Audio/SoundBuffer.hpp>
+#include <SFML/System/Clock.hpp>
+#include <ResourceStatistics.h>
+
+////////////////////////////////////////////////////////////
+/// \brief  Defines a registry for a resource type
+///
+/// This defines the constants needed by the registry (base path
+/// and type name) and a <name>Registry typedef.
+///
+/// \param path the base path of the resources
+/// \param type the type of the resources
+/// \param name the name used to prefix the generated symbols
+///
+////////////////////////////////////////////////////////////
+#define DEFINE_REGISTRY(path, type, name) \
+    inline constexpr const char name##Path[] = path; \
+    inline constexpr const char name##Name[] = #name; \
+    typedef ResourceRegistry<name##Path, type, name##Name> name##Registry;
+
+////////////////////////////////////////////////////////////
+/// \brief  The customization point used by the registry to
+///         load a resource
+///
+/// The default implementation works for every type that has a
+/// loadFromFile(path) method. Specialize this structure to
+/// support other types (see ResourceLoader<sf::Shader>).
+///
+/// A loader needs to provide:
+///  - Load, which loads the resource in place, reports the time
+///    spent decoding and uploading it, and returns false on failure
+///  - GetCpuSize and GetGpuSize, which return the memory used by a
+///    loaded resource in RAM and VRAM, in bytes. They are used to
+///    enforce the budget of the registry
+///  - DEFAULT_BUDGET, the default budget of the registry, in bytes
+///
+/// \tparam T the type of the resources
+///
+////////////////////////////////////////////////////////////
+template <typename T>
+struct ResourceLoader
+{
+    static constexpr uint64_t DEFAULT_BUDGET = 16 * 1024 * 1024;
+
+    static bool Load(T& resource, const std::string& path, ResourceLoadStatistics& statistics)
+    {
+        sf::Clock clock;
+        bool loaded = resource.loadFromFile(path);
+        statistics.decodeTime = clock.getElapsedTime().asMicroseconds();
+        return loaded;
+    }
+
+    static uint64_t GetCpuSize(const T& resource) { return sizeof(T); }
+    static uint64_t GetGpuSize(const T& resource) { return 0; }
+};
+
+template <>
+struct ResourceLoader<sf::Texture>
+{
+    static constexpr uint64_t DEFAULT_BUDGET = 256 * 1024 * 1024;
+
+    static bool Load(sf::Texture& texture, const std::string& path, ResourceLoadStatistics& statistics)
+    {
+        // Decode and upload separately to know which one is slow
+        sf::Clock clock;
+        sf::Image image;
+        if(!image.loadFromFile(path))
+            return false;
+        statistics.decodeTime = clock.restart().asMicroseconds();
+
+        bool loaded = texture.loadFromImage(image);
+        statistics.uploadTime = clock.getElapsedTime().asMicroseconds();
+        return loaded;
+    }
+
+    static uint64_t GetCpuSize(const sf::Texture&) { return sizeof(sf::Texture); }
+
+    // Textures are stored as RGBA8
+    static uint64_t GetGpuSize(const sf::Texture& texture)
+    {
+        return static_cast<uint64_t>(texture.getSize().x) * texture.getSize().y * 4;
+    }
+};
+
+template <>
+struct ResourceLoader<sf::Image>
+{
+    static constexpr uint64_t DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+    static bool Load(sf::Image& image, const std::string& path, ResourceLoadStatistics& statistics)
+    {
+        sf::Clock clock;
+        bool loaded = image.loadFromFile(path);
+        statistics.decodeTime = clock.getElapsedTime().asMicroseconds();
+        return loaded;
+    }
+
+    // Images are stored as RGBA8
+    static uint64_t GetCpuSize(const sf::Image& image)
+    {
+        return static_cast<uint64_t>(image.getSize().x) * image.getSize().y * 4;
+    }
+
+    static uint64_t GetGpuSize(const sf::Image&) { return 0; }
+};
+
+template <>
+struct ResourceLoader<sf::SoundBuffer>
+{
+    static constexpr uint64_t DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+    static bool Load(sf::SoundBuffer& buffer, const std::string& path, ResourceLoadStatistics& statistics)
+    {
+        sf::Clock clock;
+        bool loaded = buffer.loadFromFile(path);
+        statistics.decodeTime = clock.getElapsedTime().asMicroseconds();
+        return loaded;
+    }
+
+    // Samples are stored as 16-bit integers
+    static uint64_t GetCpuSize(const sf::SoundBuffer& buffer) { return buffer.getSampleCount() * sizeof(int16_t); }
+    static uint64_t GetGpuSize(const sf::SoundBuffer&) { return 0; }
+};
+
+template <>
+struct ResourceLoader<sf::Shader>
+{
+    static constexpr uint64_t DEFAULT_BUDGET = 1024 * 1024;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Loads a shader
+    ///
+    /// If the path ends with .vert, .geom or .frag, only this
+    /// stage is loaded. Otherwise, the path is used as a base name
+    /// and both <path>.vert and <path>.frag are loaded.
+    ///
+    /// The compilation is reported as upload time.
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool Load(sf::Shader& shader, const std::string& path, ResourceLoadStatistics& statistics)
+    {
+        sf::Clock clock;
+        bool loaded;
+        if(path.ends_with(".vert"))
+            loaded = shader.loadFromFile(path, sf::Shader::Type::Vertex);
+        else if(path.ends_with(".geom"))
+            loaded = shader.loadFromFile(path, sf::Shader::Type::Geometry);
+        else if(path.ends_with(".frag"))
+            loaded = shader.loadFromFile(path, sf::Shader::Type::Fragment);
+        else
+            loaded = shader.loadFromFile(path + ".vert", path + ".frag");
+
+        statistics.uploadTime = clock.getElapsedTime().asMicroseconds();
+        return loaded;
+    }
+
+    // Shader programs live on the GPU and are tiny, we only count the object itself
+    static uint64_t GetCpuSize(const sf::Shader&) { return sizeof(sf::Shader); }
+    static uint64_t GetGpuSize(const sf::Shader&) { return 0; }
+};
 
-#ifdef DEBUG
-#define DEFINE_REGISTRY(path, type) \
-    constexpr const char type##Path[] = path; \
-    constexpr const char type##Name[] = #type;\
-    typedef ResourceRegistry<type##Path, type, type##Name> type##Registry;
-template <char const* BASE_PATH, typename T, const char* TYPE_NAME>
-#else
-#define DEFINE_REGISTRY(path, type) \
-    constexpr const char type##Path = path; \
-    ResourceRegistry<type##Path, type>
-template <char const* BASE_PATH, typename T>
-#endif
 ////////////////////////////////////////////////////////////
 /// \brief  A registry for resources
 ///
 /// This class is used to register resources and to get a
 /// handle to them. The resources are loaded only once and
-/// are kept in memory until the last handle is destroyed.
+/// are kept in memory while at least one handle exists.
+///
+/// When the last handle of a resource is destroyed, the
+/// resource stays cached until the resident memory of the
+/// registry exceeds its budget. Unused resources are then
+/// unloaded, the least recently used first.
+///
+/// A resource whose file changed is invalidated: the next
+/// request loads it again, while the existing handles keep
+/// the previous version until they are destroyed.
+///
+/// Resources are loaded outside of the registry lock, so
+/// multiple threads can load different resources at the same
+/// time. Threads requesting a resource that is being loaded
+/// wait for the load to finish.
 ///
 /// \tparam BASE_PATH the base path of the resources
 /// \tparam T the type of the resources
 /// \tparam TYPE_NAME the name of the type of the resources
-///         (only available on debug)
+///
+/// \see ResourceLoader
 ///
 ////////////////////////////////////////////////////////////
+template <char const* BASE_PATH, typename T, const char* TYPE_NAME>
 class ResourceRegistry
 {
+    typedef ResourceLoader<T> Loader;
+
+    // A resource stored in the registry
+    struct Element
+    {
+        uint64_t usageCount = 0;
+        uint64_t hits = 0;
+        uint64_t cpuSize = 0;
+        uint64_t gpuSize = 0;
+        int64_t loadTime = 0;
+        ResourceLoadStatistics loadStatistics;
+        bool loaded = false;
+        bool cached = false; // true if the element is in the unused list
+        bool invalidated = false; // true if the element is no longer returned by GetResource
+        std::list<const std::string*>::iterator unusedIterator;
+        std::mutex loadMutex;
+        T resource;
+    };
+
 public:
     ResourceRegistry() = default;
     ResourceRegistry(const ResourceRegistry&) = delete;
@@ -48,7 +237,7 @@ public:
     /// This class is used to get a reference to a resource.
     /// This is needed because we need to keep track of the
     /// number of handles to a resource to know when to unload
-    /// it. The resource is unloaded when the last handle is
+    /// it. The resource can be unloaded once the last handle is
     /// destroyed.
     ///
     /// You can get a handle to a resource by calling
@@ -89,9 +278,9 @@ public:
         //////////////////////////////////////////////////////////////
         ResourceHandle(ResourceHandle&& other) noexcept
         {
-            m_registry = std::move(other.m_registry);
-            m_element = std::move(other.m_element);
-            m_path = std::move(other.m_path);
+            m_registry = other.m_registry;
+            m_element = other.m_element;
+            m_path = other.m_path;
 
             other.m_registry = nullptr;
             other.m_element = nullptr;
@@ -103,6 +292,7 @@ public:
         ///
         /// This operator does the same thing as the move constructor,
         /// except that it is used when assigning a handle to another.
+        /// The resource previously held by this handle is released.
         ///
         /// \param other the handle to move
         /// \return a reference to this handle
@@ -110,9 +300,15 @@ public:
         //////////////////////////////////////////////////////////////
         ResourceHandle& operator=(ResourceHandle&& other) noexcept
         {
-            m_registry = std::move(other.m_registry);
-            m_element = std::move(other.m_element);
-            m_path = std::move(other.m_path);
+            if(this == &other)
+                return *this;
+
+            if(m_registry != nullptr)
+                m_registry->UnregisterHandle(m_path, m_element);
+
+            m_registry = other.m_registry;
+            m_element = other.m_element;
+            m_path = other.m_path;
 
             other.m_registry = nullptr;
             other.m_element = nullptr;
@@ -137,7 +333,7 @@ public:
             if(m_element == nullptr)
                 throw std::runtime_error("[ResourceRegistry] Tried to retrieve the reference of an empty handle");
 #endif
-            return std::get<1>(*m_element);
+            return m_element->resource;
         }
 
          const T* operator->() const
@@ -150,12 +346,19 @@ public:
             return &(const T&)(*this);
          }
 
+        //////////////////////////////////////////////////////////////
+        /// \brief  Checks if the handle holds a resource
+        ///
+        /// \return true if the handle is not empty
+        ///
+        //////////////////////////////////////////////////////////////
+        [[nodiscard]] bool IsValid() const { return m_element != nullptr; }
+
         //////////////////////////////////////////////////////////////
         /// \brief  The destructor.
         ///
         /// This destructor is used to unregister the handle from the
-        /// registry if it is not empty. If the last handle is destroyed,
-        /// the resource is unloaded.
+        /// registry if it is not empty.
         ///
         /// \see ResourceRegistry::UnregisterHandle
         ///
@@ -177,24 +380,19 @@ public:
         ///
         /// \param registry the registry that created the handle
         /// \param element the resource element
-        /// \param path the path of the resource
+        /// \param path the path of the resource (the key in the registry)
         ///
         /// \see ResourceRegistry::GetResource
         ///
         //////////////////////////////////////////////////////////////
-        ResourceHandle(ResourceRegistry* registry, std::tuple<uint64_t, T>* element, const char* path)
+        ResourceHandle(ResourceRegistry* registry, Element* element, const std::string* path)
             : m_registry(registry), m_element(element), m_path(path)
         {}
 
     private:
-#ifdef DEBUG
-        ResourceRegistry<BASE_PATH, T, TYPE_NAME>* m_registry = nullptr;
-#else
-        ResourceRegistry<BASE_PATH, T>* m_registry = nullptr;
-#endif
-
-        std::tuple<uint64_t, T>* m_element;
-        const char* m_path = nullptr;
+        ResourceRegistry* m_registry = nullptr;
+        Element* m_element = nullptr;
+        const std::string* m_path = nullptr;
     };
 
     //////////////////////////////////////////////////////////////
@@ -211,42 +409,206 @@ public:
     /// \see ResourceHandle
     ///
     //////////////////////////////////////////////////////////////
-    ResourceHandle GetResource(const char* path)
+    ResourceHandle GetResource(const std::string& path)
     {
         // Lock the registry mutex to prevent multiple threads from
         // modifying the registry at the same time
-        m_registryMutex.lock();
+        std::unique_lock<std::mutex> lock(m_registryMutex);
 
-        if(!m_registry.contains(path))
-        {
-            // The resource is not loaded, so we load it
+        // References to elements of an unordered_map stay valid until
+        // they are erased, so they can be shared with the handles
+        auto [iterator, inserted] = m_registry.try_emplace(path);
+        const std::string* key = &iterator->first;
+        Element& element = iterator->second;
 
-            T element;
-            if(!element.loadFromFile(std::string(BASE_PATH) + path))
-                throw std::runtime_error(std::string("[ResourceRegistry] Failed to load ")
-                    + TYPE_NAME + " at " + BASE_PATH + path);
+        if(element.cached)
+        {
+            // The resource is used again, so it can't be evicted anymore
+            m_unused.erase(element.unusedIterator);
+            element.cached = false;
+        }
 
-            // Insert the resource into the registry, with a usage count of 1
-            m_registry.insert({ path, std::make_tuple(1, element) });
+        element.usageCount += 1;
+        if(inserted)
+        {
+            m_metrics.misses += 1;
         }
         else
         {
-            // The resource is already loaded, so we increase the usage count
-            std::get<0>(m_registry[path]) += 1;
+            m_metrics.hits += 1;
+            element.hits += 1;
+        }
+
+        // Unlock the registry mutex, the resource is loaded without it
+        // so that other resources can be requested in the meantime
+        lock.unlock();
+
+        bool failed = false;
+        {
+            // Only one thread loads the resource, the others wait for it
+            std::lock_guard<std::mutex> loadLock(element.loadMutex);
+            if(!element.loaded)
+            {
+                sf::Clock clock;
+                ResourceLoadStatistics loadStatistics;
+                if(Loader::Load(element.resource, std::string(BASE_PATH) + path, loadStatistics))
+                {
+                    int64_t loadTime = clock.getElapsedTime().asMicroseconds();
+
+                    lock.lock();
+                    element.cpuSize = Loader::GetCpuSize(element.resource);
+                    element.gpuSize = Loader::GetGpuSize(element.resource);
+                    element.loadTime = loadTime;
+                    element.loadStatistics = loadStatistics;
+                    element.loaded = true;
+                    m_metrics.residentCpuBytes += element.cpuSize;
+                    m_metrics.residentGpuBytes += element.gpuSize;
+                    m_metrics.totalLoadTime += loadTime;
+                    EnforceBudget();
+                    lock.unlock();
+                }
+                else
+                {
+                    failed = true;
+                }
+            }
         }
 
-        // Unlock the registry mutex
-        m_registryMutex.unlock();
+        if(failed)
+        {
+            // Release our usage of the element, this removes it from the
+            // registry if no other thread is waiting for it
+            UnregisterHandle(key, &element);
+
+            lock.lock();
+            m_metrics.failures += 1;
+            lock.unlock();
+
+            throw std::runtime_error(std::string("[ResourceRegistry] Failed to load ")
+                + TYPE_NAME + " at " + BASE_PATH + path);
+        }
 
         // Return a handle to the resource
-        // We use std::move to avoid copying the handle
-#ifdef DEBUG
-        return ResourceHandle(this, &m_registry[path], path);
-#else
-        return ResourceHandle(*this, m_registry[path]);
-#endif
+        return ResourceHandle(this, &element, key);
+    }
+
+    //////////////////////////////////////////////////////////////
+    /// \brief  Makes the next request of a resource load it again
+    ///
+    /// This function is used when the file of a resource changed.
+    /// An unused resource is unloaded. A resource that still has
+    /// handles is kept under another key until its last handle is
+    /// destroyed, and is then unloaded instead of being cached.
+    ///
+    /// \param path the path of the resource, relative to BASE_PATH
+    ///
+    //////////////////////////////////////////////////////////////
+    void Invalidate(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(m_registryMutex);
+
+        auto iterator = m_registry.find(path);
+        if(iterator == m_registry.end())
+            return;
+
+        Element& element = iterator->second;
+        if(element.cached)
+        {
+            m_unused.erase(element.unusedIterator);
+            m_metrics.residentCpuBytes -= element.cpuSize;
+            m_metrics.residentGpuBytes -= element.gpuSize;
+            m_registry.erase(iterator);
+            return;
+        }
+
+        // The handles point to the element and to its key, which both stay
+        // valid when the node is extracted and inserted again. The new key
+        // cannot be requested, as paths do not contain a '\n'
+        auto node = m_registry.extract(iterator);
+        node.key() += "\n" + std::to_string(++m_invalidations);
+        node.mapped().invalidated = true;
+        m_registry.insert(std::move(node));
+    }
+
+    //////////////////////////////////////////////////////////////
+    /// \brief  Sets the budget of the registry
+    ///
+    /// The budget is the amount of memory (RAM and VRAM) the registry
+    /// can use before unloading the resources that are not used anymore.
+    /// Resources that are still used are never unloaded, so the
+    /// resident memory can exceed the budget.
+    ///
+    /// \param budget the budget in bytes
+    ///
+    //////////////////////////////////////////////////////////////
+    void SetBudget(uint64_t budget)
+    {
+        std::lock_guard<std::mutex> lock(m_registryMutex);
+        m_budget = budget;
+        EnforceBudget();
+    }
+
+    //////////////////////////////////////////////////////////////
+    /// \brief  Returns the metrics of the registry
+    ///
+    /// \return a copy of the metrics, taken atomically
+    ///
+    //////////////////////////////////////////////////////////////
+    [[nodiscard]] ResourceRegistryMetrics GetMetrics()
+    {
+        std::lock_guard<std::mutex> lock(m_registryMutex);
+        ResourceRegistryMetrics metrics = m_metrics;
+        metrics.budget = m_budget;
+        metrics.resourceCount = m_registry.size();
+        return metrics;
+    }
+
+    //////////////////////////////////////////////////////////////
+    /// \brief  Returns the statistics of the registry and of each
+    ///         loaded resource
+    ///
+    /// \return a copy of the statistics, taken atomically
+    ///
+    /// \see ResourceStatisticsReport
+    ///
+    //////////////////////////////////////////////////////////////
+    [[nodiscard]] ResourceRegistryStatistics GetStatistics()
+    {
+        std::lock_guard<std::mutex> lock(m_registryMutex);
+
+        ResourceRegistryStatistics statistics{TYPE_NAME, m_metrics, {}};
+        statistics.metrics.budget = m_budget;
+        statistics.metrics.resourceCount = m_registry.size();
+
+        statistics.resources.reserve(m_registry.size());
+        for(const auto& [path, element] : m_registry)
+        {
+            // Skip the resources being loaded
+            if(!element.loaded)
+                continue;
+
+            // The invalidated resources are reported with their path
+            statistics.resources.push_back({
+                path.substr(0, path.find('\n')),
+                element.usageCount,
+                element.hits,
+                element.loadTime,
+                element.loadStatistics.decodeTime,
+                element.loadStatistics.uploadTime,
+                element.cpuSize,
+                element.gpuSize
+            });
+        }
+
+        return statistics;
     }
 
+    //////////////////////////////////////////////////////////////
+    /// \brief  Returns the name of the type of the resources
+    ///
+    //////////////////////////////////////////////////////////////
+    [[nodiscard]] static constexpr const char* GetTypeName() { return TYPE_NAME; }
+
 protected:
     friend ResourceHandle;
 
@@ -254,7 +616,9 @@ protected:
     /// \brief  Used to unregister a handle from the registry.
     ///
     /// This function is used to unregister a handle from the registry.
-    /// If the last handle is unregistered, the resource is unloaded.
+    /// If the last handle is unregistered, the resource is kept in
+    /// the unused list, or unloaded if it was never loaded or was
+    /// invalidated.
     ///
     /// \param path the path to the resource
     /// \param element the resource element
@@ -262,30 +626,81 @@ protected:
     /// \see ResourceHandle::~ResourceHandle
     ///
     //////////////////////////////////////////////////////////////
-    void UnregisterHandle(const char* path, std::tuple<uint64_t, T>* element)
+    void UnregisterHandle(const std::string* path, Element* element)
     {
         // Lock the registry mutex to prevent multiple threads from
         // modifying the registry at the same time
-        m_registryMutex.lock();
+        std::lock_guard<std::mutex> lock(m_registryMutex);
 
         // Decrease the usage count of the resource
-        std::get<0>(*element) -= 1;
-        if(std::get<0>(*element) == 0)
+        element->usageCount -= 1;
+        if(element->usageCount == 0)
         {
-            // The resource is no longer used, so we unload it
-            m_registry.erase(path);
+            if(element->invalidated)
+            {
+                // A newer version may be in the registry, this one is not cached
+                if(element->loaded)
+                {
+                    m_metrics.residentCpuBytes -= element->cpuSize;
+                    m_metrics.residentGpuBytes -= element->gpuSize;
+                }
+                m_registry.erase(*path);
+            }
+            else if(element->loaded)
+            {
+                // The resource is no longer used, we keep it until the
+                // budget is exceeded
+                element->unusedIterator = m_unused.insert(m_unused.end(), path);
+                element->cached = true;
+                EnforceBudget();
+            }
+            else
+            {
+                // The resource failed to load, so we remove it
+                m_registry.erase(*path);
+            }
         }
-
-        // Unlock the registry mutex
-        m_registryMutex.unlock();
     }
 
 private:
+    //////////////////////////////////////////////////////////////
+    /// \brief  Unloads the unused resources until the resident
+    ///         memory fits in the budget
+    ///
+    /// The registry mutex needs to be locked by the caller.
+    ///
+    //////////////////////////////////////////////////////////////
+    void EnforceBudget()
+    {
+        while(m_metrics.residentCpuBytes + m_metrics.residentGpuBytes > m_budget && !m_unused.empty())
+        {
+            // The front of the list is the least recently used resource
+            auto iterator = m_registry.find(*m_unused.front());
+            m_unused.pop_front();
+
+            m_metrics.residentCpuBytes -= iterator->second.cpuSize;
+            m_metrics.residentGpuBytes -= iterator->second.gpuSize;
+            m_metrics.evictions += 1;
+            m_registry.erase(iterator);
+        }
+    }
+
     std::mutex m_registryMutex;
-    std::unordered_map<const char*, std::tuple<uint64_t, T>> m_registry;
+    std::unordered_map<std::string, Element> m_registry;
+
+    // The paths of the loaded resources without handles, in the
+    // order they were released
+    std::list<const std::string*> m_unused;
+
+    // The number of resources invalidated while they were used, to give them unique keys
+    uint64_t m_invalidations = 0;
+
+    uint64_t m_budget = Loader::DEFAULT_BUDGET;
+    ResourceRegistryMetrics m_metrics;
 };
 
-namespace {
-    using namespace sf;
-    DEFINE_REGISTRY("assets/textures/", Texture)
-}
\ No newline at end of file
+DEFINE_REGISTRY("assets/textures/", sf::Texture, Texture)
+DEFINE_REGISTRY("assets/textures/", sf::Image, Image)
+DEFINE_REGISTRY("assets/fonts/", sf::Font, Font)
+DEFINE_REGISTRY("assets/sounds/", sf::SoundBuffer, SoundBuffer)
+DEFINE_REGISTRY("assets/shaders/", sf::Shader, Shader)
@@ -0,0 +1,106 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+/// \brief  The timings reported by a resource loader
+///
+/// Decoding is the work done on the CPU (reading and parsing the
+/// file), uploading is the work done to send the resource to the
+/// GPU. The times are in microseconds.
+///
+/// \see ResourceLoader
+///
+////////////////////////////////////////////////////////////
+struct ResourceLoadStatistics
+{
+    int64_t decodeTime = 0;
+    int64_t uploadTime = 0;
+};
+
+////////////////////////////////////////////////////////////
+/// \brief  The statistics of a resource of a registry
+///
+////////////////////////////////////////////////////////////
+struct ResourceStatistics
+{
+    std::string path;
+    uint64_t usageCount = 0; // number of handles
+    uint64_t hits = 0; // number of requests served from the cache
+    int64_t loadTime = 0; // total time of the load, in microseconds
+    int64_t decodeTime = 0; // in microseconds
+    int64_t uploadTime = 0; // in microseconds
+    uint64_t cpuBytes = 0; // memory used in RAM
+    uint64_t gpuBytes = 0; // memory used in VRAM
+};
+
+////////////////////////////////////////////////////////////
+/// \brief  The metrics of a registry
+///
+/// \see ResourceRegistry::GetMetrics
+///
+////////////////////////////////////////////////////////////
+struct ResourceRegistryMetrics
+{
+    uint64_t hits = 0; // number of requests served from the cache
+    uint64_t misses = 0; // number of requests that needed a load
+    uint64_t failures = 0; // number of loads that failed
+    uint64_t evictions = 0; // number of unused resources unloaded to respect the budget
+    uint64_t residentCpuBytes = 0; // RAM used by all the loaded resources
+    uint64_t residentGpuBytes = 0; // VRAM used by all the loaded resources
+    int64_t totalLoadTime = 0; // time spent loading resources, in microseconds
+    uint64_t budget = 0; // the budget of the registry
+    uint64_t resourceCount = 0; // number of loaded resources (used or cached)
+};
+
+////////////////////////////////////////////////////////////
+/// \brief  The statistics of a whole registry
+///
+/// \see ResourceRegistry::GetStatistics
+///
+////////////////////////////////////////////////////////////
+struct ResourceRegistryStatistics
+{
+    const char* typeName;
+    ResourceRegistryMetrics metrics;
+    std::vector<ResourceStatistics> resources;
+};
+
+////////////////////////////////////////////////////////////
+/// \brief  Reports the statistics of the registries
+///
+/// The reports are meant to find the resources that dominate
+/// the loading time and the memory usage.
+///
+////////////////////////////////////////////////////////////
+class ResourceStatisticsReport
+{
+public:
+    ResourceStatisticsReport() = delete;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Logs the statistics of the registries
+    ///
+    /// The resources of each registry are sorted by load time.
+    ///
+    /// \param registries the statistics of the registries
+    ///
+    ////////////////////////////////////////////////////////////
+    static void Log(const std::vector<ResourceRegistryStatistics>& registries);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Writes the statistics of the registries in a JSON file
+    ///
+    /// \param registries the statistics of the registries
+    /// \param path the path of the file
+    /// \return true if the file was written
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool WriteJson(const std::vector<ResourceRegistryStatistics>& registries, const std::string& path);
+};
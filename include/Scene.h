@@ -30,7 +30,7 @@ public:
 #ifdef DEBUG
     explicit Scene(const char* name) : m_name(name) {}
 #else
-    Scene() = default;
+    explicit Scene(const char*) {}
 #endif
     virtual ~Scene() = default;
 
@@ -0,0 +1,73 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <vector>
+#include <TextureAtlas.h>
+
+////////////////////////////////////////////////////////////
+/// \brief  Draws many sprites with few draw calls
+///
+/// The sprites are accumulated in a single vertex list, and
+/// consecutive sprites using the same texture are drawn with a
+/// single draw call when the batch is flushed. When the sprites
+/// come from a TextureAtlas, most of them share a page, so a
+/// whole scene can be drawn with a handful of texture binds.
+///
+/// The drawing order is preserved.
+///
+/// \see TextureAtlas
+///
+////////////////////////////////////////////////////////////
+class SpriteBatch
+{
+public:
+    ////////////////////////////////////////////////////////////
+    /// \brief  Adds a region of a texture to the batch
+    ///
+    /// \param region the region to draw
+    /// \param transform the transform applied to the region, its
+    ///        local coordinates go from (0, 0) to the size of the region
+    /// \param color the color multiplied with the texture
+    ///
+    ////////////////////////////////////////////////////////////
+    void Draw(const TextureAtlas::Region& region, const sf::Transform& transform, sf::Color color = sf::Color::White);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Adds a sprite to the batch
+    ///
+    /// \param sprite the sprite to draw
+    ///
+    ////////////////////////////////////////////////////////////
+    void Draw(const sf::Sprite& sprite);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Draws the batch and empties it
+    ///
+    /// \param target the target to draw to
+    /// \param states the render states (the texture is overwritten)
+    ///
+    ////////////////////////////////////////////////////////////
+    void Flush(sf::RenderTarget& target, sf::RenderStates states = sf::RenderStates());
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the number of draw calls of the last flush
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline size_t GetLastDrawCallCount() const { return m_lastDrawCallCount; }
+
+private:
+    // A range of vertices using the same texture
+    struct Batch
+    {
+        const sf::Texture* texture;
+        size_t firstVertex;
+        size_t vertexCount;
+    };
+
+    std::vector<sf::Vertex> m_vertices;
+    std::vector<Batch> m_batches;
+    size_t m_lastDrawCallCount = 0;
+};
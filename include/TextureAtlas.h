@@ -0,0 +1,141 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <ResourceRegistry.h>
+
+////////////////////////////////////////////////////////////
+/// \brief  Packs small images into shared textures
+///
+/// Each image requested through GetRegion is loaded with the
+/// ImageRegistry and packed in an atlas page (a big texture)
+/// using the skyline bottom-left algorithm. Sprites using
+/// regions of the same page can be drawn without switching
+/// textures, see SpriteBatch.
+///
+/// Images bigger than MAX_PACKED_SIZE are not packed, they get
+/// their own texture from the TextureRegistry and a region
+/// covering the whole texture.
+///
+/// The regions stay valid until the atlas is destroyed.
+///
+/// \see SpriteBatch
+///
+////////////////////////////////////////////////////////////
+class TextureAtlas
+{
+public:
+    ////////////////////////////////////////////////////////////
+    /// \brief  A part of a texture of the atlas
+    ///
+    ////////////////////////////////////////////////////////////
+    struct Region
+    {
+        const sf::Texture* texture = nullptr;
+        sf::IntRect rect;
+    };
+
+    TextureAtlas() = default;
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the region of an image
+    ///
+    /// The image is packed the first time it is requested.
+    ///
+    /// \param path the path of the image, relative to the textures directory
+    /// \return the region of the image
+    /// \throw std::runtime_error if the image cannot be loaded
+    ///
+    ////////////////////////////////////////////////////////////
+    Region GetRegion(const std::string& path);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the number of pages of the atlas
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] size_t GetPageCount();
+
+    static constexpr uint32_t PAGE_SIZE = 2048;
+    static constexpr uint32_t MAX_PACKED_SIZE = PAGE_SIZE / 2;
+
+    // The width of the gutter around each image, in which its edges are
+    // extruded, so that smoothing does not bleed the neighbors of a region
+    static constexpr uint32_t PADDING = 2;
+
+private:
+    ////////////////////////////////////////////////////////////
+    /// \brief  Adds a gutter of PADDING pixels around an image,
+    ///         extruding its edges
+    ///
+    /// \param image the image, which cannot be empty
+    /// \return the padded image
+    ///
+    ////////////////////////////////////////////////////////////
+    static sf::Image AddGutter(const sf::Image& image);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  A page of the atlas
+    ///
+    /// The free space of the page is represented by its skyline:
+    /// the top edge of the packed images, from left to right.
+    ///
+    ////////////////////////////////////////////////////////////
+    class Page
+    {
+    public:
+        explicit Page(uint32_t size);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief  Finds a place for a rectangle in the page
+        ///
+        /// The lowest position is chosen, then the leftmost one.
+        ///
+        /// \param size the size of the rectangle
+        /// \param position the position of the rectangle, if it fits
+        /// \return true if the rectangle fits in the page
+        ///
+        ////////////////////////////////////////////////////////////
+        bool Insert(sf::Vector2u size, sf::Vector2u& position);
+
+        sf::Texture texture;
+
+    private:
+        struct SkylineNode
+        {
+            uint32_t x;
+            uint32_t y;
+            uint32_t width;
+        };
+
+        ////////////////////////////////////////////////////////////
+        /// \brief  Returns the height a rectangle would be placed at
+        ///         if its left edge was on a node
+        ///
+        /// \return false if the rectangle does not fit at this node
+        ///
+        ////////////////////////////////////////////////////////////
+        bool Fit(size_t nodeIndex, sf::Vector2u size, uint32_t& y) const;
+
+        uint32_t m_size;
+        std::vector<SkylineNode> m_skyline;
+    };
+
+    std::mutex m_mutex;
+
+    // Pages are allocated separately, so that the regions keep valid
+    // texture pointers when pages are added
+    std::vector<std::unique_ptr<Page>> m_pages;
+    std::unordered_map<std::string, Region> m_regions;
+
+    // The images that were too big to be packed
+    std::vector<TextureRegistry::ResourceHandle> m_standaloneTextures;
+};
@@ -74,6 +74,35 @@ public:
         m_condition.notify_one();
     }
 
+    ////////////////////////////////////////////////////////////
+    /// \brief  Runs a loop in parallel and waits for it to finish
+    ///
+    /// The indices [0, count) are split in ranges of grainSize
+    /// indices, and the ranges are shared between the threads of the
+    /// pool and the calling thread. As the calling thread takes
+    /// ranges as well, the loop finishes even if every thread of the
+    /// pool is busy, so this can be called from a task.
+    ///
+    /// If the body throws, the other ranges are still executed and
+    /// the first exception is rethrown in the calling thread.
+    ///
+    /// \param count the number of indices
+    /// \param grainSize the number of indices per range
+    /// \param body the function called with the first and past-the-end
+    ///        indices of each range
+    /// \return the number of threads which executed at least one range,
+    ///         including the calling thread
+    ///
+    ////////////////////////////////////////////////////////////
+    size_t ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the number of threads of the pool, without
+    ///         the main thread
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline size_t GetThreadCount() const { return m_threads.size(); }
+
     ////////////////////////////////////////////////////////////
     /// \brief  Terminates the thread pool
     ///
@@ -0,0 +1,109 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// The tile types the game supports (each type is associated to a system, see Tiles.h)
+enum class TileType : uint8_t
+{
+    Ground = 0,
+    Wall = 1,
+    PassagePoint = 2,
+    Path = 3,
+    Soil = 4
+};
+
+constexpr uint32_t TILE_TYPE_COUNT = static_cast<uint32_t>(TileType::Soil) + 1;
+
+// The custom data of a soil tile
+struct SoilData
+{
+    uint8_t moisture = 0;
+    uint8_t crop = 0; // 0 if nothing is planted
+    uint8_t growth = 0;
+};
+
+// The custom data of a passage point
+struct PassagePointData
+{
+    std::string tilemap; // the tilemap of the destination, empty for the same tilemap
+    uint32_t x = 0;
+    uint32_t y = 0;
+};
+
+////////////////////////////////////////////////////////////
+/// \brief  The state of a square of SIZE x SIZE tiles
+///
+/// The state common to every tile is stored as a structure of
+/// arrays, indexed by the cell of the tile in the chunk
+/// (y * SIZE + x). The custom data of a few tile types is stored
+/// in sparse side tables keyed by the same cell index, so the
+/// tiles without data cost 4 bytes.
+///
+/// Chunks are shared between the tilemap and the grids created
+/// from it through shared pointers, a grid copies a chunk the
+/// first time it modifies it (see GameGrid::GetMutableChunk).
+///
+/// The cells of the chunks on the right and bottom edges of a
+/// map that fall outside of the map are ground tiles, and are
+/// never read.
+///
+////////////////////////////////////////////////////////////
+struct TileChunk
+{
+    ////////////////////////////////////////////////////////////
+    /// \brief  Replaces a tile of the chunk
+    ///
+    /// The flags of the tile are set from its type, and its custom
+    /// data is parsed in the side table of its type.
+    ///
+    /// \param cell the cell of the tile (y * SIZE + x)
+    /// \param type the type of the tile
+    /// \param textureIndex the texture index of the tile
+    /// \param data the custom data of the tile, as stored in a tilemap file
+    /// \param size the size of the custom data
+    /// \return false if the custom data is invalid, the tile then has
+    ///         default data
+    ///
+    ////////////////////////////////////////////////////////////
+    bool SetTile(uint16_t cell, TileType type, uint16_t textureIndex, const uint8_t* data, uint32_t size);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the memory used by the chunk, in bytes
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] uint64_t GetMemorySize() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the index of the cell containing a tile
+    ///
+    /// \param x the x coordinate of the tile in the map
+    /// \param y the y coordinate of the tile in the map
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] static inline uint16_t GetCell(uint32_t x, uint32_t y)
+    {
+        return static_cast<uint16_t>((y % SIZE) * SIZE + x % SIZE);
+    }
+
+    static constexpr uint32_t SIZE = 32;
+    static constexpr uint32_t AREA = SIZE * SIZE;
+
+    // The movement traits of a tile
+    static constexpr uint8_t FLAG_SOLID = 1 << 0; // cannot be walked on
+    static constexpr uint8_t FLAG_SLOW = 1 << 1; // slows down the player
+    static constexpr uint8_t FLAG_FAST = 1 << 2; // speeds up the player, preferred by the NPCs
+
+    std::array<TileType, AREA> types{};
+    std::array<uint16_t, AREA> textureIndices{};
+    std::array<uint8_t, AREA> flags{};
+
+    std::unordered_map<uint16_t, SoilData> soil;
+    std::unordered_map<uint16_t, PassagePointData> passagePoints;
+};
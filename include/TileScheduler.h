@@ -0,0 +1,100 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <TileChunk.h>
+
+////////////////////////////////////////////////////////////
+/// \brief  Keeps track of the tiles that need to be updated
+///
+/// Tiles are static by default and cost nothing per frame. A
+/// tile that needs to be updated is registered in the active
+/// set of its type, and each type is ticked at its own rate:
+/// the system of the type then updates all its active tiles in
+/// one batch (see Tiles.h).
+///
+/// The tiles are identified by their index in the grid
+/// (y * width + x).
+///
+////////////////////////////////////////////////////////////
+class TileScheduler
+{
+public:
+    ////////////////////////////////////////////////////////////
+    /// \brief  Sets the time between two ticks of a type
+    ///
+    /// \param type the tile type
+    /// \param tickInterval the time between two ticks, in seconds
+    ///        (0 to tick every frame)
+    ///
+    ////////////////////////////////////////////////////////////
+    void SetTickInterval(TileType type, float tickInterval);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Registers a tile in the active set of its type
+    ///
+    /// Registering a tile twice has no effect.
+    ///
+    /// \param type the type of the tile
+    /// \param tile the index of the tile
+    ///
+    ////////////////////////////////////////////////////////////
+    void Activate(TileType type, uint64_t tile);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Removes a tile from the active set of its type
+    ///
+    /// \param type the type of the tile
+    /// \param tile the index of the tile
+    ///
+    ////////////////////////////////////////////////////////////
+    void Deactivate(TileType type, uint64_t tile);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Advances the clock of a type
+    ///
+    /// \param type the tile type
+    /// \param deltaTime the time since the last frame
+    /// \return the number of ticks to run for the type, 0 if it has
+    ///         no active tiles
+    ///
+    ////////////////////////////////////////////////////////////
+    uint32_t Advance(TileType type, float deltaTime);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the active tiles of a type
+    ///
+    /// The order of the tiles changes when tiles are deactivated.
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline const std::vector<uint64_t>& GetActiveTiles(TileType type) const
+    {
+        return m_activeSets[static_cast<size_t>(type)].tiles;
+    }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the total number of active tiles
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] uint64_t GetActiveTileCount() const;
+
+private:
+    struct ActiveSet
+    {
+        std::vector<uint64_t> tiles;
+
+        // The position of each tile in tiles, to remove it in constant time
+        std::unordered_map<uint64_t, size_t> positions;
+
+        float tickInterval = 0.0f;
+        float accumulator = 0.0f;
+    };
+
+    std::array<ActiveSet, TILE_TYPE_COUNT> m_activeSets;
+};
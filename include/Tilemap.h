@@ -0,0 +1,366 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <ResourceRegistry.h>
+#include <TileChunk.h>
+
+class MappedFile;
+class ThreadPool;
+
+////////////////////////////////////////////////////////////
+/// \brief  The parsed content of a tilemap file
+///
+/// A tilemap is immutable once loaded. It is stored in the
+/// TilemapRegistry, so it is parsed only once and shared by
+/// every GameGrid created from the same file. The tiles are
+/// parsed in chunks of TileChunk::SIZE x TileChunk::SIZE tiles,
+/// which the grids share until they modify them.
+///
+/// Both versions of the HTF format are supported: the version 1
+/// stores the tiles as variable size records in row-major order,
+/// the version 2 stores them chunk by chunk with an index of the
+/// chunks, so any chunk can be parsed on its own.
+///
+/// \see GameGrid::ReadFromFile for the file format
+///
+////////////////////////////////////////////////////////////
+class Tilemap
+{
+public:
+    ////////////////////////////////////////////////////////////
+    /// \brief  Loads and parses a tilemap file
+    ///
+    /// The file is mapped in memory and the tiles are parsed directly
+    /// from its pages, so the content of the file is never copied in a
+    /// buffer. The file is unmapped before the function returns.
+    ///
+    /// The chunks of a file of the version 2 are independent, they
+    /// are parsed by the threads of the pool if one is given. The
+    /// tiles of a file of the version 1 are always parsed by the
+    /// calling thread, as a tile can only be found after the previous
+    /// one.
+    ///
+    /// The chunks saved in the journal of the tilemap replace the
+    /// chunks of the file (see TilemapJournal).
+    ///
+    /// \param path the path to the file
+    /// \param threadPool the threads parsing the chunks, can be nullptr
+    /// \return true if the tilemap was loaded, false otherwise
+    ///
+    ////////////////////////////////////////////////////////////
+    bool LoadFromFile(const std::string& path, ThreadPool* threadPool = nullptr);
+
+    [[nodiscard]] inline uint32_t GetWidth() const { return m_width; }
+    [[nodiscard]] inline uint32_t GetHeight() const { return m_height; }
+    [[nodiscard]] inline const std::string& GetTilesetPath() const { return m_tilesetPath; }
+    [[nodiscard]] inline uint32_t GetChunkCountX() const { return m_chunkCountX; }
+    [[nodiscard]] inline uint32_t GetChunkCountY() const { return m_chunkCountY; }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the chunks of the tilemap
+    ///
+    /// The chunks must not be modified, a grid copies a chunk
+    /// before modifying it.
+    ///
+    /// \return the chunks, indexed by chunkY * GetChunkCountX() + chunkX
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline const std::vector<std::shared_ptr<TileChunk>>& GetChunks() const { return m_chunks; }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the memory used by the tilemap, in bytes
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] uint64_t GetMemorySize() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the number of threads which parsed the chunks
+    ///         of the file, when it was loaded
+    ///
+    /// This is 1 for the files of the version 1, or when no thread
+    /// pool was given, and can be lower than the size of the pool if
+    /// its threads were busy.
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline size_t GetParseThreadCount() const { return m_parseThreadCount; }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Measures the load time of tilemaps and logs it
+    ///
+    /// Files of the version 2 of BENCHMARK_SIZES tiles are written to
+    /// the temporary directory, with and without compression of the
+    /// tiles, then loaded on one thread and on the thread pool, and
+    /// removed. The number of threads logged is the number of threads
+    /// which took part in the load, as the threads of the pool may be
+    /// busy.
+    ///
+    /// \param threadPool the threads parsing the chunks
+    ///
+    ////////////////////////////////////////////////////////////
+    static void Benchmark(ThreadPool& threadPool);
+
+private:
+    friend class TilemapStream;
+    friend class TilemapJournal;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Parses a tile record of a file into its chunk
+    ///
+    /// \param record the record
+    /// \param available the number of bytes from the record to the end
+    ///        of the tiles
+    /// \param offset the offset of the record in the tiles, for the errors
+    /// \param x the x coordinate of the tile
+    /// \param y the y coordinate of the tile
+    /// \param chunk the chunk containing the tile
+    /// \param path the path to the file, for the errors
+    /// \return the size of the record, or 0 if it is invalid
+    ///
+    ////////////////////////////////////////////////////////////
+    static uint32_t ParseTile(const uint8_t* record, uint64_t available, uint64_t offset,
+                              uint32_t x, uint32_t y, TileChunk& chunk, const std::string& path);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Loads a file of the version 1, where the tiles are
+    ///         variable size records in row-major order
+    ///
+    ////////////////////////////////////////////////////////////
+    bool LoadVersion1(const MappedFile& file, const std::string& path);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Loads a file of the version 2, chunk by chunk
+    ///
+    ////////////////////////////////////////////////////////////
+    bool LoadVersion2(const MappedFile& file, const std::string& path, ThreadPool* threadPool);
+
+    // The magic number starting the files of the version 2 and later ("HTF2"),
+    // the files of the version 1 start with the width of the map
+    static constexpr uint32_t FORMAT_MAGIC = 0x32465448;
+    static constexpr uint16_t FORMAT_VERSION = 2;
+
+    // The sections of a file of the version 2, the unknown ones are ignored
+    enum class SectionType : uint32_t
+    {
+        TilesetPath = 1, // char[]
+        ChunkIndex = 2, // RawChunk[], one per chunk in row-major order
+        Tiles = 3, // the tiles of the chunks, see ChunkEncoding
+        TileData = 4 // RawTileData[], the custom data of the tiles
+    };
+
+    // How the tiles of a chunk are stored in the tiles section
+    enum class ChunkEncoding : uint32_t
+    {
+        // The types of the TileChunk::AREA cells (uint8_t[]), then their
+        // texture indices (uint16_t[]), the cells outside of the map included
+        Raw = 0,
+
+        // The tiles of ChunkEncoding::Raw, compressed with ChunkCodec
+        Compressed = 1
+    };
+
+    // The size of the tiles of a chunk with ChunkEncoding::Raw
+    static constexpr uint32_t RAW_CHUNK_SIZE = TileChunk::AREA * (sizeof(TileType) + sizeof(uint16_t));
+
+    // The number of chunks parsed by a thread at once. A chunk is parsed in
+    // about 15 us (see Benchmark), so taking a range of 4 chunks (an atomic
+    // increment) costs less than 1% of it, and a 256x256 map still has 16
+    // ranges to share between the threads (4 with 16 chunks per range)
+    static constexpr size_t PARSE_GRAIN_SIZE = 4;
+
+    // The width and height of the maps loaded by Benchmark, and the number of loads of each
+    static constexpr uint32_t BENCHMARK_SIZES[] = {256, 1024, 4096};
+    static constexpr uint32_t BENCHMARK_RUNS = 3;
+
+// We need to pack the structures to tell to the compiler to not add any padding
+#pragma pack(push, 1)
+    // The header of the file
+    struct RawGameGrid
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t tilesetPathSize; // size of the tilemaps path
+        uint32_t tilesSize; // total size of tiles
+        uint32_t entitiesSize; // total size of entities
+        uint8_t data[];
+    };
+
+    // The tile structure in the file
+    struct RawGameTile
+    {
+        TileType type;
+        uint32_t size; // size of total structure
+        uint32_t textureIndex; // offset in texture names
+        uint8_t data[]; // custom data
+    };
+
+    // The entity structure in the file (TODO)
+    struct RawGameEntity
+    {
+        uint32_t size; // size of total structure
+        uint32_t textureIndex; // offset in texture names
+        uint8_t data[]; // custom data
+    };
+
+    // The header of a file of the version 2, followed by the section table
+    struct RawTilemapHeader
+    {
+        uint32_t magic; // FORMAT_MAGIC
+        uint16_t version;
+        uint16_t sectionCount;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    // An entry of the section table
+    struct RawSection
+    {
+        SectionType type;
+        uint64_t offset; // offset of the section in the file
+        uint64_t size;
+    };
+
+    // An entry of the chunk index
+    struct RawChunk
+    {
+        uint64_t tilesOffset; // offset of the tiles in the tiles section
+        uint32_t tilesSize;
+        ChunkEncoding encoding;
+        uint64_t dataOffset; // offset of the custom data in the tile data section
+        uint32_t dataSize;
+    };
+
+    // The custom data of a tile, the records of a chunk are sorted by cell
+    struct RawTileData
+    {
+        uint16_t cell;
+        uint32_t size; // size of total structure
+        uint8_t data[]; // custom data, described by the system of the type of the tile
+    };
+#pragma pack(pop)
+
+    // Where the parts of a file of the version 2 are
+    struct FileLayout
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::string tilesetPath;
+        std::vector<RawChunk> chunks;
+
+        // The tiles and tile data sections, in the mapped file
+        const uint8_t* tiles = nullptr;
+        const uint8_t* tileData = nullptr;
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Reads the header, the section table, the tileset path
+    ///         and the chunk index of a file of the version 2
+    ///
+    /// The chunks of the index are checked to be inside of their
+    /// sections, so they can be read without checking again.
+    ///
+    /// \param file the file
+    /// \param path the path to the file, for the errors
+    /// \param layout the layout of the file
+    /// \return true if the file is valid, false otherwise
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool ReadLayout(const MappedFile& file, const std::string& path, FileLayout& layout);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Checks that an entry of the chunk index can be parsed
+    ///
+    /// The tiles and the data of the chunk must be inside of their
+    /// sections, and its encoding must be known. ParseChunk relies on
+    /// these checks.
+    ///
+    /// \param entry the entry of the chunk
+    /// \param tilesSize the size of the tiles section
+    /// \param dataSize the size of the tile data section
+    /// \param chunkX the x coordinate of the chunk, in chunks, for the errors
+    /// \param chunkY the y coordinate of the chunk, in chunks, for the errors
+    /// \param path the path to the file, for the errors
+    /// \return true if the entry is valid, false otherwise
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool CheckChunk(const RawChunk& entry, uint64_t tilesSize, uint64_t dataSize,
+                           uint32_t chunkX, uint32_t chunkY, const std::string& path);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Parses the tiles and the custom data of a chunk of a
+    ///         file of the version 2
+    ///
+    /// The entry must have been checked with CheckChunk.
+    ///
+    /// \param entry the entry of the chunk in the index
+    /// \param tiles the tiles of the chunk, entry.tilesSize bytes
+    /// \param data the custom data of the chunk, entry.dataSize bytes
+    /// \param chunkX the x coordinate of the chunk, in chunks, for the errors
+    /// \param chunkY the y coordinate of the chunk, in chunks, for the errors
+    /// \param chunk the chunk to fill
+    /// \param path the path to the file, for the errors
+    /// \return true if the chunk is valid, false otherwise
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool ParseChunk(const RawChunk& entry, const uint8_t* tiles, const uint8_t* data,
+                           uint32_t chunkX, uint32_t chunkY, TileChunk& chunk, const std::string& path);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Serializes a chunk as stored in a file of the version 2
+    ///
+    /// The tiles are compressed if it makes them smaller.
+    ///
+    /// \param chunk the chunk
+    /// \param tiles the tiles of the chunk, replaced
+    /// \param data the custom data of the tiles of the chunk, replaced
+    /// \param entry the entry of the chunk in the index, only its sizes and
+    ///        encoding are set
+    /// \param compress false to store the tiles with ChunkEncoding::Raw
+    ///
+    ////////////////////////////////////////////////////////////
+    static void SerializeChunk(const TileChunk& chunk, std::vector<uint8_t>& tiles,
+                               std::vector<uint8_t>& data, RawChunk& entry, bool compress = true);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Writes a file of the version 2 for Benchmark
+    ///
+    /// The map only depends on its size, so the raw and compressed
+    /// files of a size contain the same tiles.
+    ///
+    /// \param path the path to the file
+    /// \param size the width and height of the map
+    /// \param compress false to store the tiles with ChunkEncoding::Raw
+    /// \return the size of the file, or 0 if it cannot be written
+    ///
+    ////////////////////////////////////////////////////////////
+    static uint64_t WriteBenchmarkFile(const std::string& path, uint32_t size, bool compress);
+
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_chunkCountX = 0;
+    uint32_t m_chunkCountY = 0;
+    std::string m_tilesetPath;
+    size_t m_parseThreadCount = 1;
+
+    std::vector<std::shared_ptr<TileChunk>> m_chunks;
+};
+
+template <>
+struct ResourceLoader<Tilemap>
+{
+    static constexpr uint64_t DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+    // The chunks are parsed by the thread pool of the application
+    static bool Load(Tilemap& tilemap, const std::string& path, ResourceLoadStatistics& statistics);
+
+    static uint64_t GetCpuSize(const Tilemap& tilemap) { return tilemap.GetMemorySize(); }
+    static uint64_t GetGpuSize(const Tilemap&) { return 0; }
+};
+
+DEFINE_REGISTRY("assets/tilemaps/", Tilemap, Tilemap)
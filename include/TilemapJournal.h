@@ -0,0 +1,285 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <TileChunk.h>
+#include <Tilemap.h>
+
+////////////////////////////////////////////////////////////
+/// \brief  The saved chunks of a tilemap
+///
+/// The tilemap file is never rewritten: a save appends the chunks
+/// modified since the previous save to a journal next to it (the
+/// path of the tilemap followed by JOURNAL_EXTENSION), so its cost
+/// only depends on the number of modified chunks. When a tilemap
+/// is loaded, the last saved version of each chunk of the journal
+/// replaces the chunk of the file.
+///
+/// A save is a record per chunk, followed by a commit record which
+/// counts them. Each record has a CRC-32 checksum, and the journal
+/// is synced to the disk before a save is done. When the journal
+/// is opened, the records after the last valid commit (an
+/// interrupted save, or a save being written) are ignored, so a save
+/// is either fully applied or not at all.
+///
+/// Each save adds a version of its chunks, so the journal is
+/// compacted when the older versions take most of its size: only
+/// the last version of each chunk is copied to a new journal, which
+/// then replaces the old one.
+///
+/// Only one journal object writes the journal of a tilemap: the
+/// writer locks a file next to the journal (its path followed by
+/// LOCK_EXTENSION) until it is destroyed, and the other journal
+/// objects opened in Mode::Write, in this program or another one,
+/// are opened in Mode::Read instead. Only the writer removes the
+/// records after the last commit, which may be the save it is
+/// writing. The chunks can be loaded by any thread, even during a
+/// save. A reader may fail to load a chunk once the writer compacted
+/// the journal, as its records moved: the checksum rejects them.
+///
+/// Journal:
+/// ----------------------------------------------
+/// | magic    | version  | reserved | records  |
+/// ----------------------------------------------
+/// | uint32_t | uint16_t | uint16_t | Record[] |
+/// ----------------------------------------------
+///
+/// Record:
+/// ---------------------------------------------------
+/// | type     | size     | checksum | content        |
+/// ---------------------------------------------------
+/// | uint32_t | uint32_t | uint32_t | uint8_t[]      |
+/// ---------------------------------------------------
+///
+/// The size is the size of the whole record, the checksum covers
+/// the record with a checksum of 0. The content of a chunk record
+/// (type 1) is the coordinates of the chunk (2 uint32_t), its entry
+/// of the chunk index of the version 2 of the HTF format, then its
+/// tiles and its tile data (see GameGrid::ReadFromFile). The offsets
+/// of the entry are relative to the end of the entry. The content of
+/// a commit record (type 2) is the number of chunk records of the
+/// save (uint32_t) and the number of the save (uint64_t).
+///
+////////////////////////////////////////////////////////////
+class TilemapJournal
+{
+public:
+    // How the journal is opened
+    enum class Mode
+    {
+        // The saved chunks are only loaded
+        Read,
+
+        // The chunks are also saved with Append
+        Write
+    };
+
+    TilemapJournal() = default;
+    ~TilemapJournal();
+
+    TilemapJournal(const TilemapJournal&) = delete;
+    TilemapJournal& operator=(const TilemapJournal&) = delete;
+
+    // A chunk to save
+    struct SavedChunk
+    {
+        uint32_t chunkX;
+        uint32_t chunkY;
+        std::shared_ptr<const TileChunk> chunk;
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Opens the journal of a tilemap, and indexes its chunks
+    ///
+    /// The journal does not need to exist, it is created by the first
+    /// save. The records after the last commit are ignored, and removed
+    /// from it in Mode::Write.
+    ///
+    /// \param tilemapPath the path to the tilemap file
+    /// \param mode Mode::Write if the chunks are saved with Append
+    /// \return false if the journal exists but is not a journal, it is
+    ///         then never written, or if it is already written by another
+    ///         journal object, it is then opened in Mode::Read
+    ///
+    ////////////////////////////////////////////////////////////
+    bool Open(const std::string& tilemapPath, Mode mode);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Saves chunks
+    ///
+    /// The chunks are appended to the journal, which is synced to the
+    /// disk before the function returns.
+    ///
+    /// \param chunks the chunks to save
+    /// \return false if the chunks cannot be written or the journal was
+    ///         opened in Mode::Read, the previous saves are kept
+    ///
+    ////////////////////////////////////////////////////////////
+    bool Append(const std::vector<SavedChunk>& chunks);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns true if the chunks can be saved with Append
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline bool IsWritable() const { return m_valid && m_mode == Mode::Write; }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns true if a chunk was saved
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] bool Contains(uint32_t chunkX, uint32_t chunkY) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Reads and parses the last saved version of a chunk
+    ///
+    /// \param chunkX the x coordinate of the chunk, in chunks
+    /// \param chunkY the y coordinate of the chunk, in chunks
+    /// \return the chunk, or nullptr if it was not saved or cannot be read
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] std::shared_ptr<TileChunk> LoadChunk(uint32_t chunkX, uint32_t chunkY) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the coordinates of the saved chunks
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] std::vector<std::pair<uint32_t, uint32_t>> GetChunks() const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the size of the journal, in bytes
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] uint64_t GetSize() const;
+
+    static constexpr const char* JOURNAL_EXTENSION = ".journal";
+    static constexpr const char* LOCK_EXTENSION = ".lock";
+
+    // The journal is compacted when it is bigger than COMPACTION_MIN_SIZE and
+    // than COMPACTION_RATIO times the size of the last versions of its chunks
+    static constexpr uint64_t COMPACTION_MIN_SIZE = 4 * 1024 * 1024;
+    static constexpr uint64_t COMPACTION_RATIO = 2;
+
+private:
+    ////////////////////////////////////////////////////////////
+    /// \brief  Copies the last version of each chunk to a new journal,
+    ///         which replaces the current one
+    ///
+    /// \return false if the journal cannot be replaced, it is then kept
+    ///
+    ////////////////////////////////////////////////////////////
+    bool Compact();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Locks the journal for this object, to write it
+    ///
+    /// \return false if another journal object holds the lock
+    ///
+    ////////////////////////////////////////////////////////////
+    bool LockWriter();
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Releases the lock taken by LockWriter, if any
+    ///
+    ////////////////////////////////////////////////////////////
+    void UnlockWriter();
+
+    static constexpr uint32_t JOURNAL_MAGIC = 0x314A5448; // "HTJ1"
+    static constexpr uint16_t JOURNAL_VERSION = 1;
+
+    enum class RecordType : uint32_t
+    {
+        Chunk = 1,
+        Commit = 2
+    };
+
+#pragma pack(push, 1)
+    struct RawJournalHeader
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t reserved;
+    };
+
+    struct RawRecord
+    {
+        RecordType type;
+        uint32_t size; // size of total structure
+        uint32_t checksum;
+    };
+
+    // Followed by the tiles and the tile data of the chunk
+    struct RawChunkRecord
+    {
+        RawRecord record;
+        uint32_t chunkX;
+        uint32_t chunkY;
+        Tilemap::RawChunk entry;
+    };
+
+    struct RawCommitRecord
+    {
+        RawRecord record;
+        uint32_t chunkCount;
+        uint64_t sequence;
+    };
+#pragma pack(pop)
+
+    // Where the last version of a chunk is in the journal
+    struct RecordLocation
+    {
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Checks that the entry of a chunk record describes its
+    ///         content and can be parsed
+    ///
+    /// \param chunkRecord the record, at least sizeof(RawChunkRecord) bytes
+    /// \return true if the entry is valid, false otherwise
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] bool CheckChunkRecord(const RawChunkRecord& chunkRecord) const;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the checksum of a record, its checksum field
+    ///         being ignored
+    ///
+    ////////////////////////////////////////////////////////////
+    static uint32_t GetChecksum(const uint8_t* record, uint32_t size);
+
+    [[nodiscard]] static inline uint64_t GetKey(uint32_t chunkX, uint32_t chunkY)
+    {
+        return (static_cast<uint64_t>(chunkY) << 32) | chunkX;
+    }
+
+    std::string m_path;
+    Mode m_mode = Mode::Read;
+    bool m_valid = false;
+
+    // The lock file held by the writer
+#ifdef _WIN32
+    void* m_lock = nullptr;
+#else
+    int m_lock = -1;
+#endif
+
+    // Locked while the index is read or updated, and while the journal is replaced
+    mutable std::mutex m_mutex;
+
+    // The last version of each saved chunk, by GetKey
+    std::unordered_map<uint64_t, RecordLocation> m_records;
+
+    // The size of the journal up to its last commit, and of the last versions
+    uint64_t m_size = 0;
+    uint64_t m_liveSize = 0;
+    uint64_t m_sequence = 0;
+};
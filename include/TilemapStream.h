@@ -0,0 +1,110 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <MappedFile.h>
+#include <TileChunk.h>
+#include <Tilemap.h>
+#include <TilemapJournal.h>
+
+////////////////////////////////////////////////////////////
+/// \brief  Reads the chunks of a tilemap file on demand
+///
+/// Unlike Tilemap, the tiles are not kept in memory. The files
+/// of the version 2 contain an index of the chunks, which is read
+/// when the file is opened. The files of the version 1 have no
+/// index: all their tile records are walked when the file is
+/// opened, to find where the part of each row inside of each chunk
+/// starts, then a chunk is parsed from its 32 row segments when it
+/// is needed. This index costs 8 bytes per row and chunk column.
+///
+/// The file is mapped in memory while the stream is open, and the
+/// chunks are parsed directly from its pages: the system only keeps
+/// the pages recently read, and can drop them at any time. LoadChunk
+/// only reads the mapping, so several chunks can be loaded at the
+/// same time.
+///
+/// The journal of the tilemap is opened with the file, and the
+/// chunks saved in it are loaded from it instead of the file. It is
+/// only written through the stream of the grid saving the tilemap.
+///
+/// \see GameGrid::StreamFromFile
+/// \see GameGrid::ReadFromFile for the file format
+///
+////////////////////////////////////////////////////////////
+class TilemapStream
+{
+public:
+    ////////////////////////////////////////////////////////////
+    /// \brief  Opens a tilemap file and indexes its tiles
+    ///
+    /// \param path the path to the file
+    /// \param journalMode TilemapJournal::Mode::Write if the chunks are
+    ///        saved to the journal returned by GetJournal
+    /// \return true if the file is a valid tilemap, false otherwise
+    ///
+    ////////////////////////////////////////////////////////////
+    bool Open(const std::string& path, TilemapJournal::Mode journalMode = TilemapJournal::Mode::Read);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Reads and parses a chunk of the tilemap
+    ///
+    /// The last saved version of the chunk is returned if it was saved.
+    ///
+    /// \param chunkX the x coordinate of the chunk, in chunks
+    /// \param chunkY the y coordinate of the chunk, in chunks
+    /// \return the chunk, or nullptr if it cannot be read
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] std::shared_ptr<TileChunk> LoadChunk(uint32_t chunkX, uint32_t chunkY) const;
+
+    [[nodiscard]] inline uint32_t GetWidth() const { return m_width; }
+    [[nodiscard]] inline uint32_t GetHeight() const { return m_height; }
+    [[nodiscard]] inline const std::string& GetTilesetPath() const { return m_tilesetPath; }
+    [[nodiscard]] inline uint32_t GetChunkCountX() const { return m_chunkCountX; }
+    [[nodiscard]] inline uint32_t GetChunkCountY() const { return m_chunkCountY; }
+    [[nodiscard]] inline const std::shared_ptr<TilemapJournal>& GetJournal() const { return m_journal; }
+    [[nodiscard]] inline uint64_t GetMemorySize() const
+    {
+        return m_segmentOffsets.size() * sizeof(uint64_t) + m_chunks.size() * sizeof(Tilemap::RawChunk);
+    }
+
+private:
+    ////////////////////////////////////////////////////////////
+    /// \brief  Opens a file of the version 2, reading its chunk index
+    ///
+    ////////////////////////////////////////////////////////////
+    bool OpenVersion2(const std::string& path);
+
+    MappedFile m_file;
+    std::string m_path;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_chunkCountX = 0;
+    uint32_t m_chunkCountY = 0;
+    std::string m_tilesetPath;
+
+    // The saves of the tilemap, shared with the grid writing them
+    std::shared_ptr<TilemapJournal> m_journal;
+
+    // The version 1 only: the offset and the size of the tiles in the file
+    uint64_t m_tilesOffset = 0;
+    uint64_t m_tilesSize = 0;
+
+    // The version 2 only: the index of the chunks, and the tiles and tile data
+    // sections in the mapped file
+    std::vector<Tilemap::RawChunk> m_chunks;
+    const uint8_t* m_tiles = nullptr;
+    const uint8_t* m_tileData = nullptr;
+
+    // The version 1 only: the offset of the first record of each row segment in the tiles, indexed
+    // by y * m_chunkCountX + chunkX, followed by the size of the tiles: a
+    // segment ends where the next one starts
+    std::vector<uint64_t> m_segmentOffsets;
+};
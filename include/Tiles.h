@@ -3,7 +3,17 @@
 //
 #pragma once
 
-#include <GameGrid.h>
+#include <TileChunk.h>
+#include <vector>
+
+// The tiles are not objects: their state is stored in the tile chunks
+// of the grid (see TileChunk), and the behavior of each type is
+// implemented by a system below. The grid dispatches on the type of
+// the tiles to call the right system, without virtual calls.
+//
+// Only the tiles registered in the TileScheduler of the grid are
+// updated, each type at its own TICK_INTERVAL, and a system updates
+// all the active tiles of its type in one batch.
 
 ////////////////////////////////////////////////////////////
 /// \brief  A tile that represents ground
@@ -11,12 +21,12 @@
 /// This tile has no special effects. The player wan walk on it
 ///
 ////////////////////////////////////////////////////////////
-class GroundTile : public GameGrid::Tile
+class GroundTile
 {
 public:
-    explicit GroundTile(uint64_t textureIndex);
+    GroundTile() = delete;
 
-    void Update(float deltaTime) override;
+    static constexpr uint8_t FLAGS = 0;
 };
 
 ////////////////////////////////////////////////////////////
@@ -25,12 +35,12 @@ public:
 /// This tile has no special effects. The player cannot walk on it
 ///
 ////////////////////////////////////////////////////////////
-class WallTile : public GameGrid::Tile
+class WallTile
 {
 public:
-    explicit WallTile(uint64_t textureIndex);
+    WallTile() = delete;
 
-    void Update(float deltaTime) override;
+    static constexpr uint8_t FLAGS = TileChunk::FLAG_SOLID;
 };
 
 ////////////////////////////////////////////////////////////
@@ -40,13 +50,44 @@ public:
 /// tilemap. This can be used to create doors or portals for
 /// exemple.
 ///
+/// Custom data:
+/// -------------------------------------------------------
+/// | tilemapSize | tilemap     | x        | y        |
+/// -------------------------------------------------------
+/// | uint8_t     | char[]      | uint32_t | uint32_t |
+/// -------------------------------------------------------
+/// | 1           | tilemapSize | 4        | 4        |
+/// -------------------------------------------------------
+///
 ////////////////////////////////////////////////////////////
-class PassagePointTile : public GameGrid::Tile
+class PassagePointTile
 {
 public:
-    PassagePointTile(uint64_t textureIndex, const uint8_t* data, uint32_t size);
+    PassagePointTile() = delete;
 
-    void Update(float deltaTime) override;
+    static constexpr uint8_t FLAGS = 0;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Parses the custom data of a passage point
+    ///
+    /// \param data the custom data
+    /// \param size the size of the custom data
+    /// \param passagePoint the parsed destination
+    /// \return false if the data is invalid
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool ParseData(const uint8_t* data, uint32_t size, PassagePointData& passagePoint);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Appends the custom data of a passage point
+    ///
+    /// The name of the tilemap is truncated to 255 characters.
+    ///
+    /// \param passagePoint the destination
+    /// \param data the buffer the custom data is appended to
+    ///
+    ////////////////////////////////////////////////////////////
+    static void SerializeData(const PassagePointData& passagePoint, std::vector<uint8_t>& data);
 };
 
 ////////////////////////////////////////////////////////////
@@ -56,12 +97,12 @@ public:
 /// prefer to walk on it if possible.
 ///
 ////////////////////////////////////////////////////////////
-class PathTile : public GameGrid::Tile
+class PathTile
 {
 public:
-    explicit PathTile(uint64_t textureIndex);
+    PathTile() = delete;
 
-    void Update(float deltaTime) override;
+    static constexpr uint8_t FLAGS = TileChunk::FLAG_FAST;
 };
 
 ////////////////////////////////////////////////////////////
@@ -70,11 +111,66 @@ public:
 /// This tile will slow down the player, but it is the only tile
 /// that lets the player plant things.
 ///
+/// Custom data (optional, a soil without data is dry and empty):
+/// ----------------------------------
+/// | moisture | crop     | growth   |
+/// ----------------------------------
+/// | uint8_t  | uint8_t  | uint8_t  |
+/// ----------------------------------
+/// | 1        | 1        | 1        |
+/// ----------------------------------
+///
 ////////////////////////////////////////////////////////////
-class SoilTile : public GameGrid::Tile
+class SoilTile
 {
 public:
-    SoilTile(uint64_t textureIndex, const uint8_t* data, uint32_t size);
+    SoilTile() = delete;
 
-    void Update(float deltaTime) override;
-};
\ No newline at end of file
+    static constexpr uint8_t FLAGS = TileChunk::FLAG_SLOW;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Parses the custom data of a soil
+    ///
+    /// \param data the custom data
+    /// \param size the size of the custom data
+    /// \param soil the parsed soil
+    /// \return false if the data is invalid
+    ///
+    ////////////////////////////////////////////////////////////
+    static bool ParseData(const uint8_t* data, uint32_t size, SoilData& soil);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Appends the custom data of a soil
+    ///
+    /// Nothing is appended for a dry and empty soil.
+    ///
+    /// \param soil the soil
+    /// \param data the buffer the custom data is appended to
+    ///
+    ////////////////////////////////////////////////////////////
+    static void SerializeData(const SoilData& soil, std::vector<uint8_t>& data);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns true if a soil needs to be updated
+    ///
+    /// A dry soil does not change, even if something is planted.
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] static inline bool IsActive(const SoilData& soil) { return soil.moisture > 0; }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Updates a batch of active soils
+    ///
+    /// At each tick, a soil dries a bit, and its crop grows if it
+    /// was still moist.
+    ///
+    /// \param soils the soils to update
+    /// \param count the number of soils
+    /// \param ticks the number of ticks since the last update
+    ///
+    ////////////////////////////////////////////////////////////
+    static void Update(SoilData* const* soils, size_t count, uint32_t ticks);
+
+    static constexpr float TICK_INTERVAL = 1.0f;
+    static constexpr uint8_t MAX_GROWTH = 255;
+};
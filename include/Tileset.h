@@ -0,0 +1,128 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ResourceRegistry.h>
+
+////////////////////////////////////////////////////////////
+/// \brief  A tileset prepared for minification
+///
+/// When a tileset is loaded, every tile is copied in a cell
+/// bigger than the tile, and the edges of the tile are extruded
+/// in the gutter around it. Mipmaps are then generated for the
+/// padded texture.
+///
+/// Without the gutters, the mipmaps (and the filtering) would
+/// mix the pixels of adjacent tiles. The cells are placed every
+/// CELL_SIZE pixels, so the texels of the mip levels up to
+/// log2(CLEAN_MIP_FACTOR) never straddle two cells.
+///
+/// The texture is not smooth: magnification keeps the pixel
+/// art sharp, while minification uses the mipmaps.
+///
+////////////////////////////////////////////////////////////
+class Tileset
+{
+public:
+    ////////////////////////////////////////////////////////////
+    /// \brief  Loads a tileset image and prepares its texture
+    ///
+    /// The padding is reported as decode time, the texture creation
+    /// and the mipmaps generation as upload time.
+    ///
+    /// \param path the path to the image
+    /// \param statistics the statistics of the load
+    /// \return true if the tileset was loaded, false otherwise
+    ///
+    ////////////////////////////////////////////////////////////
+    bool LoadFromFile(const std::string& path, ResourceLoadStatistics& statistics);
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Adds extruded gutters around the tiles of an image
+    ///
+    /// \param source the image containing the tiles, without spacing
+    /// \param columns the number of tiles per row of the source
+    /// \param rows the number of rows of the source
+    /// \return the padded image
+    ///
+    ////////////////////////////////////////////////////////////
+    static sf::Image AddGutters(const sf::Image& source, uint32_t columns, uint32_t rows);
+
+    [[nodiscard]] inline const sf::Texture& GetTexture() const { return m_texture; }
+    [[nodiscard]] inline uint32_t GetColumnCount() const { return m_columns; }
+    [[nodiscard]] inline uint32_t GetTileCount() const { return m_columns * m_rows; }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the texture coordinates of the top-left
+    ///         corner of a tile
+    ///
+    /// The origins of the tiles of the tileset are computed once
+    /// when it is loaded, as this is called for every tile of the
+    /// grids.
+    ///
+    /// \param textureIndex the index of the tile in the source image
+    ///        (row-major)
+    /// \return the coordinates in pixels, the tile spans TILE_SIZE
+    ///         pixels from there
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] inline sf::Vector2f GetTileOrigin(uint64_t textureIndex) const
+    {
+        if(textureIndex < m_tileOrigins.size())
+        {
+            return m_tileOrigins[textureIndex];
+        }
+
+        // Not a tile of the tileset, the texture coordinates fall outside the texture
+        return {
+            static_cast<float>(textureIndex % m_columns * CELL_SIZE + GUTTER),
+            static_cast<float>(textureIndex / m_columns * CELL_SIZE + GUTTER)
+        };
+    }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief  Returns the memory used by the texture, with its
+    ///         mipmaps, in bytes
+    ///
+    ////////////////////////////////////////////////////////////
+    [[nodiscard]] uint64_t GetMemorySize() const;
+
+    static constexpr uint32_t TILE_SIZE = 32;
+    static constexpr uint32_t GUTTER = 8;
+    static constexpr uint32_t CELL_SIZE = TILE_SIZE + 2 * GUTTER;
+
+    // The biggest downscale at which tiles do not bleed on each other
+    static constexpr uint32_t CLEAN_MIP_FACTOR = 2 * GUTTER;
+
+private:
+    sf::Texture m_texture;
+    uint32_t m_columns = 1;
+    uint32_t m_rows = 0;
+
+    // The result of GetTileOrigin for every tile
+    std::vector<sf::Vector2f> m_tileOrigins;
+};
+
+template <>
+struct ResourceLoader<Tileset>
+{
+    static constexpr uint64_t DEFAULT_BUDGET = 128 * 1024 * 1024;
+
+    static bool Load(Tileset& tileset, const std::string& path, ResourceLoadStatistics& statistics)
+    {
+        return tileset.LoadFromFile(path, statistics);
+    }
+
+    static uint64_t GetCpuSize(const Tileset& tileset)
+    {
+        return sizeof(Tileset) + tileset.GetTileCount() * sizeof(sf::Vector2f);
+    }
+    static uint64_t GetGpuSize(const Tileset& tileset) { return tileset.GetMemorySize(); }
+};
+
+DEFINE_REGISTRY("assets/textures/", Tileset, Tileset)
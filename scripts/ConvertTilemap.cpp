@@ -0,0 +1,269 @@
+//
+// Created by Killian on 19/10/2026.
+//
+// Converts a tilemap of the version 1 of the HTF format to the version 2
+// (see GameGrid::ReadFromFile for both formats).
+//
+// Usage: ConvertTilemap [--compress] <input.htf> [output.htf]
+// The input is replaced when no output is given. With --compress, the tiles
+// of each chunk are compressed when it makes them smaller.
+//
+// Build: g++ -std=c++20 -Iinclude scripts/ConvertTilemap.cpp src/ChunkCodec.cpp
+//
+#include <ChunkCodec.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+constexpr uint32_t FORMAT_MAGIC = 0x32465448; // "HTF2"
+constexpr uint16_t FORMAT_VERSION = 2;
+constexpr uint32_t CHUNK_SIZE = 32;
+constexpr uint32_t CHUNK_AREA = CHUNK_SIZE * CHUNK_SIZE;
+
+enum class SectionType : uint32_t
+{
+    TilesetPath = 1,
+    ChunkIndex = 2,
+    Tiles = 3,
+    TileData = 4
+};
+
+enum class ChunkEncoding : uint32_t
+{
+    Raw = 0,
+    Compressed = 1
+};
+
+#pragma pack(push, 1)
+// Version 1
+struct RawGameGrid
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t tilesetPathSize;
+    uint32_t tilesSize;
+    uint32_t entitiesSize;
+};
+
+struct RawGameTile
+{
+    uint8_t type;
+    uint32_t size; // size of total structure
+    uint32_t textureIndex;
+};
+
+// Version 2
+struct RawTilemapHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t sectionCount;
+    uint32_t width;
+    uint32_t height;
+};
+
+struct RawSection
+{
+    SectionType type;
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct RawChunk
+{
+    uint64_t tilesOffset;
+    uint32_t tilesSize;
+    ChunkEncoding encoding;
+    uint64_t dataOffset;
+    uint32_t dataSize;
+};
+
+struct RawTileData
+{
+    uint16_t cell;
+    uint32_t size; // size of total structure
+};
+#pragma pack(pop)
+
+// The tiles of a chunk, as stored with ChunkEncoding::Raw
+struct Chunk
+{
+    uint8_t types[CHUNK_AREA] = {};
+    uint16_t textureIndices[CHUNK_AREA] = {};
+    std::vector<uint8_t> data; // RawTileData records, sorted by cell
+    std::vector<uint8_t> tiles; // the tiles as written in the file
+};
+
+int main(int argc, char** argv)
+{
+    bool compress = argc > 1 && std::strcmp(argv[1], "--compress") == 0;
+    int firstArgument = compress ? 2 : 1;
+    if(argc <= firstArgument)
+    {
+        std::fprintf(stderr, "Usage: %s [--compress] <input.htf> [output.htf]\n", argv[0]);
+        return 1;
+    }
+    std::string inPath = argv[firstArgument];
+    std::string outPath = argc > firstArgument + 1 ? argv[firstArgument + 1] : inPath;
+
+    std::ifstream in(inPath, std::ios::binary);
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    RawGameGrid header{};
+    if(file.size() < sizeof(RawGameGrid))
+    {
+        std::fprintf(stderr, "%s is not a tilemap\n", inPath.c_str());
+        return 1;
+    }
+    std::memcpy(&header, file.data(), sizeof(RawGameGrid));
+
+    uint32_t magic;
+    std::memcpy(&magic, file.data(), sizeof(uint32_t));
+    if(magic == FORMAT_MAGIC)
+    {
+        std::fprintf(stderr, "%s is already in the version 2\n", inPath.c_str());
+        return 1;
+    }
+
+    if(file.size() != sizeof(RawGameGrid) + static_cast<uint64_t>(header.tilesetPathSize) + header.tilesSize + header.entitiesSize)
+    {
+        std::fprintf(stderr, "%s has an invalid size\n", inPath.c_str());
+        return 1;
+    }
+
+    // The version 2 has no section for the entities yet, they would be lost
+    if(header.entitiesSize != 0)
+    {
+        std::fprintf(stderr, "%s contains entities, which cannot be converted\n", inPath.c_str());
+        return 1;
+    }
+
+    const uint8_t* tilesetPath = file.data() + sizeof(RawGameGrid);
+    const uint8_t* tiles = tilesetPath + header.tilesetPathSize;
+
+    // Split the records of the tiles in their chunks, the records are in row-major order
+    uint32_t chunkCountX = (header.width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    uint32_t chunkCountY = (header.height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::vector<Chunk> chunks(static_cast<uint64_t>(chunkCountX) * chunkCountY);
+
+    uint64_t tileCount = static_cast<uint64_t>(header.width) * header.height;
+    uint64_t offset = 0;
+    for(uint64_t i = 0; i < tileCount; i++)
+    {
+        RawGameTile tile{};
+        if(header.tilesSize - offset < sizeof(RawGameTile))
+        {
+            std::fprintf(stderr, "%s contains %llu tiles, expected %llu\n", inPath.c_str(),
+                static_cast<unsigned long long>(i), static_cast<unsigned long long>(tileCount));
+            return 1;
+        }
+        std::memcpy(&tile, tiles + offset, sizeof(RawGameTile));
+        if(tile.size < sizeof(RawGameTile) || tile.size > header.tilesSize - offset || tile.textureIndex > UINT16_MAX)
+        {
+            std::fprintf(stderr, "Invalid tile record at offset %llu in %s\n",
+                static_cast<unsigned long long>(offset), inPath.c_str());
+            return 1;
+        }
+
+        auto x = static_cast<uint32_t>(i % header.width);
+        auto y = static_cast<uint32_t>(i / header.width);
+        Chunk& chunk = chunks[(y / CHUNK_SIZE) * chunkCountX + x / CHUNK_SIZE];
+        auto cell = static_cast<uint16_t>((y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE);
+        chunk.types[cell] = tile.type;
+        chunk.textureIndices[cell] = static_cast<uint16_t>(tile.textureIndex);
+
+        // The cells are visited in increasing order in each chunk
+        uint32_t dataSize = tile.size - sizeof(RawGameTile);
+        if(dataSize > 0)
+        {
+            RawTileData record{cell, static_cast<uint32_t>(sizeof(RawTileData) + dataSize)};
+            auto* recordBytes = reinterpret_cast<const uint8_t*>(&record);
+            chunk.data.insert(chunk.data.end(), recordBytes, recordBytes + sizeof(RawTileData));
+            chunk.data.insert(chunk.data.end(), tiles + offset + sizeof(RawGameTile), tiles + offset + tile.size);
+        }
+
+        offset += tile.size;
+    }
+
+    if(offset != header.tilesSize)
+    {
+        std::fprintf(stderr, "%s contains more than %llu tiles\n", inPath.c_str(), static_cast<unsigned long long>(tileCount));
+        return 1;
+    }
+
+    // Lay out the sections after the section table
+    constexpr uint16_t sectionCount = 4;
+    std::vector<RawChunk> index(chunks.size());
+    uint64_t tilesSize = 0;
+    uint64_t dataSize = 0;
+    for(size_t i = 0; i < chunks.size(); i++)
+    {
+        Chunk& chunk = chunks[i];
+        auto* types = reinterpret_cast<const uint8_t*>(chunk.types);
+        auto* textureIndices = reinterpret_cast<const uint8_t*>(chunk.textureIndices);
+        chunk.tiles.assign(types, types + sizeof(chunk.types));
+        chunk.tiles.insert(chunk.tiles.end(), textureIndices, textureIndices + sizeof(chunk.textureIndices));
+
+        index[i].encoding = ChunkEncoding::Raw;
+        if(compress)
+        {
+            std::vector<uint8_t> compressed;
+            ChunkCodec::Compress(chunk.tiles.data(), static_cast<uint32_t>(chunk.tiles.size()), compressed);
+            if(compressed.size() < chunk.tiles.size())
+            {
+                chunk.tiles = std::move(compressed);
+                index[i].encoding = ChunkEncoding::Compressed;
+            }
+        }
+
+        index[i].tilesOffset = tilesSize;
+        index[i].tilesSize = static_cast<uint32_t>(chunk.tiles.size());
+        index[i].dataOffset = dataSize;
+        index[i].dataSize = static_cast<uint32_t>(chunks[i].data.size());
+        tilesSize += index[i].tilesSize;
+        dataSize += index[i].dataSize;
+    }
+
+    RawSection sections[sectionCount] = {
+        {SectionType::TilesetPath, 0, header.tilesetPathSize},
+        {SectionType::ChunkIndex, 0, index.size() * sizeof(RawChunk)},
+        {SectionType::Tiles, 0, tilesSize},
+        {SectionType::TileData, 0, dataSize}
+    };
+    uint64_t sectionOffset = sizeof(RawTilemapHeader) + sizeof(sections);
+    for(RawSection& section : sections)
+    {
+        section.offset = sectionOffset;
+        sectionOffset += section.size;
+    }
+
+    RawTilemapHeader outHeader{FORMAT_MAGIC, FORMAT_VERSION, sectionCount, header.width, header.height};
+    std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&outHeader), sizeof(outHeader));
+    out.write(reinterpret_cast<const char*>(sections), sizeof(sections));
+    out.write(reinterpret_cast<const char*>(tilesetPath), header.tilesetPathSize);
+    out.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(RawChunk)));
+    for(const Chunk& chunk : chunks)
+    {
+        out.write(reinterpret_cast<const char*>(chunk.tiles.data()), static_cast<std::streamsize>(chunk.tiles.size()));
+    }
+    for(const Chunk& chunk : chunks)
+    {
+        out.write(reinterpret_cast<const char*>(chunk.data.data()), static_cast<std::streamsize>(chunk.data.size()));
+    }
+
+    if(!out)
+    {
+        std::fprintf(stderr, "Failed to write %s\n", outPath.c_str());
+        return 1;
+    }
+
+    std::printf("%s: %llu bytes -> %s: %llu bytes\n", inPath.c_str(), static_cast<unsigned long long>(file.size()),
+        outPath.c_str(), static_cast<unsigned long long>(sectionOffset));
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include <cstdint>
 #include <string>
 #include <fstream>
+#include <cstring>
 
 enum class TileType : uint8_t
 {
@@ -90,15 +91,18 @@ public:
 
     RawGameTile* Serialize() override
     {
-        uint64_t size = sizeof(RawGameTile) + m_tilemap.size() + sizeof(uint64_t) * 3;
+        // tilemapSize (uint8_t), tilemap, x (uint32_t), y (uint32_t)
+        uint64_t size = sizeof(RawGameTile) + 1 + m_tilemap.size() + sizeof(uint32_t) * 2;
         RawGameTile* tile = (RawGameTile*)malloc(size);
         tile->type = TileType::PassagePoint;
         tile->size = size;
         tile->textureIndex = m_textureIndex;
         tile->data[0] = m_tilemap.size();
         memcpy(tile->data + 1, m_tilemap.c_str(), m_tilemap.size());
-        tile->data[m_tilemap.size() + 1] = m_position.first;
-        tile->data[m_tilemap.size() + 2] = m_position.second;
+        uint32_t x = m_position.first;
+        uint32_t y = m_position.second;
+        memcpy(tile->data + 1 + m_tilemap.size(), &x, sizeof(uint32_t));
+        memcpy(tile->data + 1 + m_tilemap.size() + sizeof(uint32_t), &y, sizeof(uint32_t));
         return tile;
     }
 
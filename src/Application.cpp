@@ -84,6 +84,19 @@ void Application::Update(float deltaTime)
             return;
         }
 
+        // Dump the resource statistics on demand, to the log (F3) or to a file (F4)
+        if(event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3)
+        {
+            ResourceStatisticsReport::Log(GetResourceStatistics());
+        }
+        else if(event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F4)
+        {
+            if(ResourceStatisticsReport::WriteJson(GetResourceStatistics(), RESOURCE_STATISTICS_PATH))
+            {
+                SPDLOG_INFO("Resource statistics written to {}", RESOURCE_STATISTICS_PATH);
+            }
+        }
+
         m_currentScene->HandleEvent(event);
     }
 
@@ -107,4 +120,17 @@ void Application::Render()
 
     // Display the frame to the screen
     m_window.display();
+}
+
+std::vector<ResourceRegistryStatistics> Application::GetResourceStatistics()
+{
+    return {
+        m_textureRegistry.GetStatistics(),
+        m_imageRegistry.GetStatistics(),
+        m_fontRegistry.GetStatistics(),
+        m_soundBufferRegistry.GetStatistics(),
+        m_shaderRegistry.GetStatistics(),
+        m_tilemapRegistry.GetStatistics(),
+        m_tilesetRegistry.GetStatistics()
+    };
 }
\ No newline at end of file
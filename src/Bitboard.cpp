@@ -0,0 +1,93 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <Bitboard.h>
+#include <bit>
+
+Bitboard::Bitboard(uint32_t width, uint32_t height)
+    : m_width(width), m_height(height), m_wordsPerRow((width + 63) / 64)
+{
+    m_words.resize(static_cast<size_t>(m_wordsPerRow) * height, 0);
+}
+
+template<typename F>
+void Bitboard::ForEachWord(uint32_t x, uint32_t y, uint32_t width, uint32_t height, F&& function) const
+{
+    if(width == 0 || height == 0)
+    {
+        return;
+    }
+
+    // Only the first and the last words of a row are partially inside of the rectangle
+    uint32_t firstWord = x / 64;
+    uint32_t lastWord = (x + width - 1) / 64;
+    uint64_t firstMask = ~uint64_t(0) << (x % 64);
+    uint64_t lastMask = ~uint64_t(0) >> (63 - (x + width - 1) % 64);
+
+    for(uint32_t row = y; row < y + height; row++)
+    {
+        const uint64_t* words = m_words.data() + static_cast<size_t>(row) * m_wordsPerRow;
+        if(firstWord == lastWord)
+        {
+            if(!function(words[firstWord], firstMask & lastMask))
+            {
+                return;
+            }
+            continue;
+        }
+
+        if(!function(words[firstWord], firstMask))
+        {
+            return;
+        }
+
+        for(uint32_t word = firstWord + 1; word < lastWord; word++)
+        {
+            if(!function(words[word], ~uint64_t(0)))
+            {
+                return;
+            }
+        }
+
+        if(!function(words[lastWord], lastMask))
+        {
+            return;
+        }
+    }
+}
+
+bool Bitboard::Any(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const
+{
+    bool any = false;
+    ForEachWord(x, y, width, height, [&any](uint64_t word, uint64_t mask)
+    {
+        any = (word & mask) != 0;
+        return !any;
+    });
+
+    return any;
+}
+
+bool Bitboard::All(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const
+{
+    bool all = true;
+    ForEachWord(x, y, width, height, [&all](uint64_t word, uint64_t mask)
+    {
+        all = (word & mask) == mask;
+        return all;
+    });
+
+    return all;
+}
+
+uint64_t Bitboard::Count(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const
+{
+    uint64_t count = 0;
+    ForEachWord(x, y, width, height, [&count](uint64_t word, uint64_t mask)
+    {
+        count += std::popcount(word & mask);
+        return true;
+    });
+
+    return count;
+}
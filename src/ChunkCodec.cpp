@@ -0,0 +1,198 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <ChunkCodec.h>
+#include <algorithm>
+#include <array>
+
+namespace
+{
+    // The number of entries of the hash table of the compressor
+    constexpr uint32_t HASH_BITS = 12;
+
+    // The next MIN_COPY_LENGTH bytes, hashed
+    inline uint32_t Hash(const uint8_t* data)
+    {
+        uint32_t value = data[0] | (data[1] << 8) | (data[2] << 16);
+        return (value * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    // Appends a count of a token, which holds up to 14 in 4 bits
+    void WriteCount(std::vector<uint8_t>& compressed, uint32_t count)
+    {
+        for(count -= 15; count >= 255; count -= 255)
+        {
+            compressed.push_back(255);
+        }
+        compressed.push_back(static_cast<uint8_t>(count));
+    }
+
+    bool ReadCount(const uint8_t* compressed, uint32_t compressedSize, uint32_t& position, uint32_t& count)
+    {
+        uint8_t byte;
+        do
+        {
+            if(position == compressedSize)
+            {
+                return false;
+            }
+            byte = compressed[position++];
+            count += byte;
+        } while(byte == 255);
+
+        return true;
+    }
+
+    void WriteSequence(std::vector<uint8_t>& compressed, const uint8_t* literals, uint32_t literalCount,
+                       uint32_t offset, uint32_t copyLength)
+    {
+        uint32_t lengthCode = copyLength == 0 ? 0 : copyLength - ChunkCodec::MIN_COPY_LENGTH;
+        compressed.push_back(static_cast<uint8_t>((std::min(literalCount, 15u) << 4) | std::min(lengthCode, 15u)));
+        if(literalCount >= 15)
+        {
+            WriteCount(compressed, literalCount);
+        }
+        compressed.insert(compressed.end(), literals, literals + literalCount);
+
+        if(copyLength != 0)
+        {
+            compressed.push_back(static_cast<uint8_t>(offset));
+            compressed.push_back(static_cast<uint8_t>(offset >> 8));
+            if(lengthCode >= 15)
+            {
+                WriteCount(compressed, lengthCode);
+            }
+        }
+    }
+}
+
+void ChunkCodec::Compress(const uint8_t* data, uint32_t size, std::vector<uint8_t>& compressed)
+{
+    compressed.clear();
+
+    // The last position where each hash was seen, plus one
+    std::array<uint32_t, 1 << HASH_BITS> positions{};
+
+    // The length of the copy of the earlier bytes at an offset
+    auto getCopyLength = [data, size](uint32_t position, uint32_t offset)
+    {
+        uint32_t length = 0;
+        while(position + length < size && data[position + length] == data[position + length - offset])
+        {
+            length++;
+        }
+        return length;
+    };
+
+    uint32_t literalStart = 0;
+    uint32_t position = 0;
+    while(position + MIN_COPY_LENGTH <= size)
+    {
+        // Runs of bytes and of 16 bits values first, then the last bytes with
+        // the same hash
+        uint32_t bestOffset = 0;
+        uint32_t bestLength = 0;
+        for(uint32_t offset : {1u, 2u})
+        {
+            if(position >= offset)
+            {
+                uint32_t length = getCopyLength(position, offset);
+                if(length > bestLength)
+                {
+                    bestOffset = offset;
+                    bestLength = length;
+                }
+            }
+        }
+
+        uint32_t& candidate = positions[Hash(data + position)];
+        if(candidate != 0 && position - (candidate - 1) > 2)
+        {
+            uint32_t length = getCopyLength(position, position - (candidate - 1));
+            if(length > bestLength)
+            {
+                bestOffset = position - (candidate - 1);
+                bestLength = length;
+            }
+        }
+        candidate = position + 1;
+
+        if(bestLength < MIN_COPY_LENGTH)
+        {
+            position++;
+            continue;
+        }
+
+        WriteSequence(compressed, data + literalStart, position - literalStart, bestOffset, bestLength);
+        position += bestLength;
+        literalStart = position;
+    }
+
+    WriteSequence(compressed, data + literalStart, size - literalStart, 0, 0);
+}
+
+bool ChunkCodec::Decompress(const uint8_t* compressed, uint32_t compressedSize, uint8_t* data, uint32_t size)
+{
+    uint32_t position = 0;
+    uint32_t written = 0;
+    while(position < compressedSize)
+    {
+        uint8_t token = compressed[position++];
+
+        uint32_t literalCount = token >> 4;
+        if(literalCount == 15 && !ReadCount(compressed, compressedSize, position, literalCount))
+        {
+            return false;
+        }
+
+        if(literalCount > compressedSize - position || literalCount > size - written)
+        {
+            return false;
+        }
+        std::copy_n(compressed + position, literalCount, data + written);
+        position += literalCount;
+        written += literalCount;
+
+        // The last sequence has no copy
+        if(position == compressedSize)
+        {
+            return written == size;
+        }
+
+        if(compressedSize - position < sizeof(uint16_t))
+        {
+            return false;
+        }
+        uint32_t offset = compressed[position] | (compressed[position + 1] << 8);
+        position += sizeof(uint16_t);
+
+        uint32_t copyLength = token & 15;
+        if(copyLength == 15 && !ReadCount(compressed, compressedSize, position, copyLength))
+        {
+            return false;
+        }
+        copyLength += MIN_COPY_LENGTH;
+
+        if(offset == 0 || offset > written || copyLength > size - written)
+        {
+            return false;
+        }
+
+        // A copy overlapping its own output repeats the last offset bytes
+        if(offset >= copyLength)
+        {
+            std::copy_n(data + written - offset, copyLength, data + written);
+            written += copyLength;
+        }
+        else
+        {
+            for(uint32_t i = 0; i < copyLength; i++, written++)
+            {
+                data[written] = data[written - offset];
+            }
+        }
+    }
+
+    // The buffer does not end with the last sequence, it was truncated
+    return false;
+}
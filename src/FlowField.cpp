@@ -0,0 +1,260 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <FlowField.h>
+#include <GameGrid.h>
+#include <ThreadPool.h>
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+    // The bits returned by RelaxChunk
+    constexpr uint8_t BORDER_LEFT = 1 << 0;
+    constexpr uint8_t BORDER_RIGHT = 1 << 1;
+    constexpr uint8_t BORDER_TOP = 1 << 2;
+    constexpr uint8_t BORDER_BOTTOM = 1 << 3;
+
+    // The open list of the chunk searches, kept by each thread
+    thread_local std::vector<std::pair<uint32_t, uint32_t>> s_openTiles;
+}
+
+FlowField::FlowField(const GameGrid& grid, sf::Vector2u destination, uint32_t regionRadius, ThreadPool& threadPool)
+    : m_movementCosts(grid.GetMovementCosts()), m_gridWidth(grid.GetWidth()), m_destination(destination),
+      m_firstX(0), m_firstY(0), m_width(0), m_height(0),
+      m_firstChunkX(0), m_firstChunkY(0), m_chunkCountX(0), m_chunkCountY(0)
+{
+    // The region is only computed around a destination of the grid, the field
+    // is empty otherwise
+    if(destination.x >= grid.GetWidth() || destination.y >= grid.GetHeight()
+       || grid.GetMovementCost(destination.x, destination.y) == 0)
+    {
+        return;
+    }
+
+    uint32_t chunkX = destination.x / GameGrid::CHUNK_SIZE;
+    uint32_t chunkY = destination.y / GameGrid::CHUNK_SIZE;
+    m_firstChunkX = chunkX - std::min(chunkX, regionRadius);
+    m_firstChunkY = chunkY - std::min(chunkY, regionRadius);
+    m_chunkCountX = std::min(chunkX + regionRadius + 1, grid.GetChunkCountX()) - m_firstChunkX;
+    m_chunkCountY = std::min(chunkY + regionRadius + 1, grid.GetChunkCountY()) - m_firstChunkY;
+
+    m_firstX = m_firstChunkX * GameGrid::CHUNK_SIZE;
+    m_firstY = m_firstChunkY * GameGrid::CHUNK_SIZE;
+    m_width = std::min((m_firstChunkX + m_chunkCountX) * GameGrid::CHUNK_SIZE, grid.GetWidth()) - m_firstX;
+    m_height = std::min((m_firstChunkY + m_chunkCountY) * GameGrid::CHUNK_SIZE, grid.GetHeight()) - m_firstY;
+
+    m_costs.assign(static_cast<size_t>(m_width) * m_height, UNREACHABLE);
+    m_directions.assign(m_costs.size(), Direction::None);
+
+    // Integration field: only the chunk of the destination has something to
+    // relax at first, the costs then spread to the neighbors of the relaxed chunks
+    m_costs[(destination.y - m_firstY) * m_width + destination.x - m_firstX] = 0;
+    std::vector<bool> pendingChunks(static_cast<size_t>(m_chunkCountX) * m_chunkCountY, false);
+    pendingChunks[(chunkY - m_firstChunkY) * m_chunkCountX + chunkX - m_firstChunkX] = true;
+
+    std::vector<uint32_t> batch;
+    std::vector<uint8_t> lowered;
+    uint32_t idleColors = 0;
+    for(uint32_t color = 0; idleColors < 2; color ^= 1)
+    {
+        batch.clear();
+        for(uint32_t i = 0; i < pendingChunks.size(); i++)
+        {
+            if(pendingChunks[i] && (i % m_chunkCountX + i / m_chunkCountX) % 2 == color)
+            {
+                batch.push_back(i);
+                pendingChunks[i] = false;
+            }
+        }
+
+        if(batch.empty())
+        {
+            idleColors++;
+            continue;
+        }
+        idleColors = 0;
+
+        // The chunks of a color do not share a border, each one only writes its
+        // own tiles and reads the borders of the chunks of the other color
+        lowered.assign(batch.size(), 0);
+        threadPool.ParallelFor(batch.size(), 1, [this, &batch, &lowered](size_t begin, size_t end)
+        {
+            for(size_t i = begin; i < end; i++)
+            {
+                lowered[i] = RelaxChunk(batch[i] % m_chunkCountX, batch[i] / m_chunkCountX);
+            }
+        });
+
+        for(size_t i = 0; i < batch.size(); i++)
+        {
+            uint32_t x = batch[i] % m_chunkCountX;
+            uint32_t y = batch[i] / m_chunkCountX;
+            if((lowered[i] & BORDER_LEFT) && x > 0) pendingChunks[batch[i] - 1] = true;
+            if((lowered[i] & BORDER_RIGHT) && x + 1 < m_chunkCountX) pendingChunks[batch[i] + 1] = true;
+            if((lowered[i] & BORDER_TOP) && y > 0) pendingChunks[batch[i] - m_chunkCountX] = true;
+            if((lowered[i] & BORDER_BOTTOM) && y + 1 < m_chunkCountY) pendingChunks[batch[i] + m_chunkCountX] = true;
+        }
+    }
+
+    // Direction field: each tile only reads the final costs of its neighbors
+    threadPool.ParallelFor(m_height, 16, [this](size_t begin, size_t end)
+    {
+        for(size_t row = begin; row < end; row++)
+        {
+            UpdateDirections(static_cast<uint32_t>(row));
+        }
+    });
+}
+
+uint32_t FlowField::GetCost(uint32_t x, uint32_t y) const
+{
+    if(!Contains(x, y))
+    {
+        return UNREACHABLE;
+    }
+
+    return m_costs[(y - m_firstY) * m_width + x - m_firstX];
+}
+
+FlowField::Direction FlowField::GetDirection(uint32_t x, uint32_t y) const
+{
+    if(!Contains(x, y))
+    {
+        return Direction::None;
+    }
+
+    return m_directions[(y - m_firstY) * m_width + x - m_firstX];
+}
+
+uint8_t FlowField::RelaxChunk(uint32_t chunkX, uint32_t chunkY)
+{
+    uint32_t firstX = chunkX * GameGrid::CHUNK_SIZE;
+    uint32_t firstY = chunkY * GameGrid::CHUNK_SIZE;
+    uint32_t lastX = std::min(firstX + GameGrid::CHUNK_SIZE, m_width) - 1;
+    uint32_t lastY = std::min(firstY + GameGrid::CHUNK_SIZE, m_height) - 1;
+
+    // The movement cost of a tile of the region
+    auto getMovementCost = [this](uint32_t x, uint32_t y)
+    {
+        return m_movementCosts[static_cast<size_t>(m_firstY + y) * m_gridWidth + m_firstX + x];
+    };
+
+    std::vector<std::pair<uint32_t, uint32_t>>& openTiles = s_openTiles;
+    openTiles.clear();
+
+    auto lower = [&](uint32_t x, uint32_t y, uint32_t cost)
+    {
+        uint32_t& currentCost = m_costs[y * m_width + x];
+        if(cost < currentCost)
+        {
+            currentCost = cost;
+            openTiles.emplace_back(cost, y * m_width + x);
+            std::push_heap(openTiles.begin(), openTiles.end(), std::greater<>());
+        }
+    };
+
+    // Going from a tile of the border to the neighbor chunk enters the tile of the neighbor
+    auto seed = [&](uint32_t x, uint32_t y, uint32_t neighborX, uint32_t neighborY)
+    {
+        uint32_t neighborCost = m_costs[neighborY * m_width + neighborX];
+        if(neighborCost != UNREACHABLE && getMovementCost(x, y) != 0)
+        {
+            lower(x, y, neighborCost + getMovementCost(neighborX, neighborY));
+        }
+    };
+
+    for(uint32_t y = firstY; y <= lastY; y++)
+    {
+        if(firstX > 0) seed(firstX, y, firstX - 1, y);
+        if(lastX + 1 < m_width) seed(lastX, y, lastX + 1, y);
+    }
+    for(uint32_t x = firstX; x <= lastX; x++)
+    {
+        if(firstY > 0) seed(x, firstY, x, firstY - 1);
+        if(lastY + 1 < m_height) seed(x, lastY, x, lastY + 1);
+    }
+
+    // The destination is the first tile of its chunk to be relaxed
+    if(m_destination.x - m_firstX >= firstX && m_destination.x - m_firstX <= lastX
+       && m_destination.y - m_firstY >= firstY && m_destination.y - m_firstY <= lastY)
+    {
+        openTiles.emplace_back(0, (m_destination.y - m_firstY) * m_width + m_destination.x - m_firstX);
+        std::push_heap(openTiles.begin(), openTiles.end(), std::greater<>());
+    }
+
+    // Dijkstra inside of the chunk, the paths are followed backwards
+    uint8_t loweredBorders = 0;
+    while(!openTiles.empty())
+    {
+        std::pop_heap(openTiles.begin(), openTiles.end(), std::greater<>());
+        auto [cost, index] = openTiles.back();
+        openTiles.pop_back();
+        if(cost > m_costs[index])
+        {
+            continue;
+        }
+
+        uint32_t x = index % m_width;
+        uint32_t y = index / m_width;
+        if(x == firstX) loweredBorders |= BORDER_LEFT;
+        if(x == lastX) loweredBorders |= BORDER_RIGHT;
+        if(y == firstY) loweredBorders |= BORDER_TOP;
+        if(y == lastY) loweredBorders |= BORDER_BOTTOM;
+
+        // The step from a neighbor enters this tile
+        uint32_t neighborCost = cost + getMovementCost(x, y);
+        auto visit = [&](uint32_t neighborX, uint32_t neighborY)
+        {
+            if(getMovementCost(neighborX, neighborY) != 0)
+            {
+                lower(neighborX, neighborY, neighborCost);
+            }
+        };
+
+        if(x > firstX) visit(x - 1, y);
+        if(x < lastX) visit(x + 1, y);
+        if(y > firstY) visit(x, y - 1);
+        if(y < lastY) visit(x, y + 1);
+    }
+
+    return loweredBorders;
+}
+
+void FlowField::UpdateDirections(uint32_t row)
+{
+    for(uint32_t x = 0; x < m_width; x++)
+    {
+        uint32_t index = row * m_width + x;
+        if(m_costs[index] == 0 || m_costs[index] == UNREACHABLE)
+        {
+            continue;
+        }
+
+        // The neighbor on the cheapest path
+        Direction direction = Direction::None;
+        uint32_t bestCost = UNREACHABLE;
+        auto consider = [&](uint32_t neighborX, uint32_t neighborY, Direction neighborDirection)
+        {
+            uint32_t neighborCost = m_costs[neighborY * m_width + neighborX];
+            if(neighborCost == UNREACHABLE)
+            {
+                return;
+            }
+
+            neighborCost += m_movementCosts[static_cast<size_t>(m_firstY + neighborY) * m_gridWidth + m_firstX + neighborX];
+            if(neighborCost < bestCost)
+            {
+                bestCost = neighborCost;
+                direction = neighborDirection;
+            }
+        };
+
+        if(x > 0) consider(x - 1, row, Direction::Left);
+        if(x + 1 < m_width) consider(x + 1, row, Direction::Right);
+        if(row > 0) consider(x, row - 1, Direction::Up);
+        if(row + 1 < m_height) consider(x, row + 1, Direction::Down);
+
+        m_directions[index] = direction;
+    }
+}
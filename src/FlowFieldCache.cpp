@@ -0,0 +1,90 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <FlowFieldCache.h>
+#include <GameGrid.h>
+#include <algorithm>
+
+FlowFieldCache::FlowFieldCache(const GameGrid& grid, ThreadPool& threadPool, uint32_t regionRadius)
+    : m_grid(grid), m_threadPool(threadPool), m_regionRadius(regionRadius), m_gridVersion(grid.GetVersion())
+{
+    size_t chunkCount = static_cast<size_t>(grid.GetChunkCountX()) * grid.GetChunkCountY();
+    m_chunkVersions.resize(chunkCount);
+    m_loadedChunks.resize(chunkCount);
+    for(uint32_t i = 0; i < chunkCount; i++)
+    {
+        m_chunkVersions[i] = grid.GetChunkVersion(i);
+        m_loadedChunks[i] = IsChunkLoaded(i);
+    }
+}
+
+std::shared_ptr<const FlowField> FlowFieldCache::GetFlowField(sf::Vector2u destination)
+{
+    m_useCounter++;
+    for(Entry& entry : m_entries)
+    {
+        if(entry.field->GetDestination() == destination)
+        {
+            entry.lastUse = m_useCounter;
+            return entry.field;
+        }
+    }
+
+    // Replace the least recently used field
+    if(m_entries.size() >= MAX_FIELD_COUNT)
+    {
+        auto oldest = std::min_element(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b)
+        {
+            return a.lastUse < b.lastUse;
+        });
+        m_entries.erase(oldest);
+    }
+
+    auto field = std::make_shared<const FlowField>(m_grid, destination, m_regionRadius, m_threadPool);
+    m_entries.push_back({field, m_useCounter});
+
+    SPDLOG_DEBUG("[FlowFieldCache] Flow field to ({}, {}) computed, {} KiB",
+        destination.x, destination.y, field->GetMemorySize() / 1024);
+
+    return field;
+}
+
+void FlowFieldCache::Refresh()
+{
+    // Nothing was replaced, loaded or unloaded since the last refresh
+    if(m_grid.GetVersion() == m_gridVersion)
+    {
+        return;
+    }
+    m_gridVersion = m_grid.GetVersion();
+
+    uint32_t chunkCountX = m_grid.GetChunkCountX();
+    for(uint32_t i = 0; i < m_chunkVersions.size(); i++)
+    {
+        uint32_t version = m_grid.GetChunkVersion(i);
+        bool loaded = IsChunkLoaded(i);
+        if(version == m_chunkVersions[i] && loaded == m_loadedChunks[i])
+        {
+            continue;
+        }
+        m_chunkVersions[i] = version;
+        m_loadedChunks[i] = loaded;
+
+        // The costs of the region may be lower or higher anywhere
+        std::erase_if(m_entries, [i, chunkCountX](const Entry& entry)
+        {
+            return entry.field->ContainsChunk(i % chunkCountX, i / chunkCountX);
+        });
+    }
+}
+
+void FlowFieldCache::Clear()
+{
+    m_entries.clear();
+}
+
+bool FlowFieldCache::IsChunkLoaded(uint32_t chunkIndex) const
+{
+    uint32_t chunkCountX = m_grid.GetChunkCountX();
+    return m_grid.IsTileLoaded(chunkIndex % chunkCountX * GameGrid::CHUNK_SIZE, chunkIndex / chunkCountX * GameGrid::CHUNK_SIZE);
+}
@@ -2,100 +2,1323 @@
 // Created by Killian on 21/03/2023.
 //
 #include <GameGrid.h>
-#include <fstream>
 #include <Application.h>
 #include <Tiles.h>
+#include <SFML/OpenGL.hpp>
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
 
-std::unique_ptr<GameGrid::Tile> GameGrid::Tile::ParseRawTile(RawGameTile* rawTile)
-{
-    // Check against all available types, and return nullptr if none match
-    switch(rawTile->type)
-    {
-    case TileType::Ground:
-        return std::make_unique<GroundTile>(rawTile->textureIndex);
-    case TileType::Wall:
-        return std::make_unique<WallTile>(rawTile->textureIndex);
-    case TileType::PassagePoint:
-        return std::make_unique<PassagePointTile>(rawTile->textureIndex, rawTile->data, rawTile->size);
-    case TileType::Path:
-        return std::make_unique<PathTile>(rawTile->textureIndex);
-    case TileType::Soil:
-        return std::make_unique<SoilTile>(rawTile->textureIndex, rawTile->data, rawTile->size);
-    default:
-        return nullptr;
-    }
+namespace
+{
+    // Passes the tile coordinates (the texture coordinates of the quad) to the fragment shader
+    const char* const TILEMAP_VERTEX_SHADER = R"(
+        #version 120
+
+        void main()
+        {
+            gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+            gl_TexCoord[0] = gl_MultiTexCoord0;
+            gl_FrontColor = gl_Color;
+        }
+    )";
+
+    // Finds the tile under the pixel, reads its texture index and samples the
+    // tileset like the vertices of RenderMode::Vertices would
+    const char* const TILEMAP_FRAGMENT_SHADER = R"(
+        #version 120
+        #extension GL_ARB_shader_texture_lod : require
+
+        uniform sampler2D tileIndices;
+        uniform sampler2D tileset;
+        uniform vec2 mapSize;
+        uniform vec2 tilesetSize;
+        uniform float columns;
+        uniform float tileSize;
+        uniform float cellSize;
+        uniform float gutter;
+
+        void main()
+        {
+            vec2 coordinates = gl_TexCoord[0].xy;
+            vec2 tile = floor(coordinates);
+
+            vec2 bytes = floor(texture2D(tileIndices, (tile + 0.5) / mapSize).rg * 255.0 + 0.5);
+            float index = bytes.r + bytes.g * 256.0;
+
+            float row = floor(index / columns);
+            float column = index - row * columns;
+            vec2 texel = vec2(column, row) * cellSize + gutter + (coordinates - tile) * tileSize;
+
+            // The derivatives of the texel jump at the edges of the tiles, the mip level
+            // is chosen from the continuous coordinates instead
+            vec2 scale = vec2(tileSize) / tilesetSize;
+            gl_FragColor = gl_Color * texture2DGradARB(
+                tileset, texel / tilesetSize, dFdx(coordinates) * scale, dFdy(coordinates) * scale);
+        }
+    )";
 }
 
 std::unique_ptr<GameGrid> GameGrid::ReadFromFile(const std::string &path)
 {
-    std::vector<std::unique_ptr<Tile>> tiles;
+    // The tilemap is only parsed if no other grid uses it
+    auto grid = std::unique_ptr<GameGrid>(new GameGrid(Application::GetInstance().GetTilemapRegistry().GetResource(path)));
+
+    // The saved chunks are already applied to the tilemap, the journal is only written
+    grid->m_journal = std::make_shared<TilemapJournal>();
+    if(!grid->m_journal->Open(std::string(TilemapPath) + path, TilemapJournal::Mode::Write))
+    {
+        SPDLOG_ERROR("[GameGrid] The journal of {} cannot be written, the grid will not be saved", path);
+    }
+    grid->m_path = path;
+    return grid;
+}
+
+std::unique_ptr<GameGrid> GameGrid::StreamFromFile(const std::string& path, uint64_t memoryBudget)
+{
+    // Only the index of the tiles is read now
+    auto stream = std::make_shared<TilemapStream>();
+    if(!stream->Open(std::string(TilemapPath) + path, TilemapJournal::Mode::Write))
+    {
+        throw std::runtime_error("[GameGrid] Failed to open the tilemap " + std::string(TilemapPath) + path);
+    }
+
+    // The stream still reads the journal if it cannot be written
+    auto grid = std::unique_ptr<GameGrid>(new GameGrid(std::move(stream), memoryBudget));
+    if(!grid->CanSave())
+    {
+        SPDLOG_ERROR("[GameGrid] The journal of {} cannot be written, the grid will not be saved", path);
+    }
+    grid->m_path = path;
+    return grid;
+}
+
+GameGrid::GameGrid(TilemapRegistry::ResourceHandle&& tilemap)
+    : m_tilemap(std::move(tilemap))
+{
+    Initialize(m_tilemap->GetWidth(), m_tilemap->GetHeight(), m_tilemap->GetTilesetPath());
+
+    // The tiles are shared with the tilemap until they are modified
+    m_tileChunks = m_tilemap->GetChunks();
+
+    // Every chunk needs to be built
+    for(uint32_t i = 0; i < m_chunks.size(); i++)
+    {
+        AddChunkTiles(i);
+        m_chunks[i].dirty = true;
+        m_dirtyChunks.push_back(i);
+    }
+}
+
+GameGrid::GameGrid(std::shared_ptr<TilemapStream> stream, uint64_t memoryBudget)
+    : m_stream(std::move(stream)), m_streamedChunks(std::make_shared<StreamedChunks>()), m_streamingBudget(memoryBudget)
+{
+    Initialize(m_stream->GetWidth(), m_stream->GetHeight(), m_stream->GetTilesetPath());
+    m_journal = m_stream->GetJournal();
+
+    // The chunks are loaded around the camera by the updates
+    m_unloadedChunk = std::make_shared<TileChunk>();
+    m_tileChunks.assign(m_chunks.size(), m_unloadedChunk);
+    for(Chunk& chunk : m_chunks)
+    {
+        chunk.state = ChunkState::Unloaded;
+    }
+}
+
+void GameGrid::Initialize(uint32_t width, uint32_t height, const std::string& tilesetPath)
+{
+    m_width = width;
+    m_height = height;
+
+    m_useVertexBuffers = sf::VertexBuffer::isAvailable();
+    if(!m_useVertexBuffers)
+    {
+        SPDLOG_WARN("[GameGrid] Vertex buffers are not available, the grid will be streamed to the GPU every frame");
+    }
+
+    m_chunkCountX = (m_width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    m_chunkCountY = (m_height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    m_chunks = std::vector<Chunk>(m_chunkCountX * m_chunkCountY);
+    m_tileset = Application::GetInstance().GetTilesetRegistry().GetResource(tilesetPath);
+
+    // The movement masks are derived from the tiles when their chunks are added,
+    // until then the tiles cannot be walked on
+    m_walkableTiles = Bitboard(m_width, m_height);
+    m_plantableTiles = Bitboard(m_width, m_height);
+    m_movementCosts.resize(static_cast<size_t>(m_width) * m_height);
+    m_chunkVersions.resize(m_chunks.size(), 0);
+
+    m_scheduler.SetTickInterval(TileType::Soil, SoilTile::TICK_INTERVAL);
+}
+
+void GameGrid::AddChunkTiles(uint32_t chunkIndex)
+{
+    uint32_t firstX = (chunkIndex % m_chunkCountX) * CHUNK_SIZE;
+    uint32_t firstY = (chunkIndex / m_chunkCountX) * CHUNK_SIZE;
+    uint32_t lastX = std::min(firstX + CHUNK_SIZE, m_width);
+    uint32_t lastY = std::min(firstY + CHUNK_SIZE, m_height);
+
+    // Derive the movement masks from the tiles
+    for(uint32_t y = firstY; y < lastY; y++)
+    {
+        for(uint32_t x = firstX; x < lastX; x++)
+        {
+            UpdateTileMasks(x, y);
+        }
+    }
+    m_version++;
+
+    // Register the tiles of the file that need to be updated
+    for(const auto& [cell, soil] : m_tileChunks[chunkIndex]->soil)
+    {
+        if(SoilTile::IsActive(soil))
+        {
+            uint64_t x = firstX + cell % CHUNK_SIZE;
+            uint64_t y = firstY + cell / CHUNK_SIZE;
+            m_scheduler.Activate(TileType::Soil, y * m_width + x);
+        }
+    }
+}
+
+void GameGrid::RemoveChunkTiles(uint32_t chunkIndex)
+{
+    uint32_t firstX = (chunkIndex % m_chunkCountX) * CHUNK_SIZE;
+    uint32_t firstY = (chunkIndex / m_chunkCountX) * CHUNK_SIZE;
+    uint32_t lastX = std::min(firstX + CHUNK_SIZE, m_width);
+    uint32_t lastY = std::min(firstY + CHUNK_SIZE, m_height);
+
+    for(uint32_t y = firstY; y < lastY; y++)
+    {
+        for(uint32_t x = firstX; x < lastX; x++)
+        {
+            m_walkableTiles.Set(x, y, false);
+            m_plantableTiles.Set(x, y, false);
+            m_movementCosts[static_cast<size_t>(y) * m_width + x] = 0;
+        }
+    }
+    m_version++;
+
+    for(const auto& [cell, soil] : m_tileChunks[chunkIndex]->soil)
+    {
+        uint64_t x = firstX + cell % CHUNK_SIZE;
+        uint64_t y = firstY + cell / CHUNK_SIZE;
+        m_scheduler.Deactivate(TileType::Soil, y * m_width + x);
+    }
+}
+
+void GameGrid::UpdateStreaming(float deltaTime)
+{
+    ChunkArea visibleChunks = GetVisibleChunks(GetCameraTransform());
+
+    // The distance from a chunk to the view, in chunks
+    auto getDistance = [this, &visibleChunks](uint32_t chunkIndex)
+    {
+        int64_t chunkX = chunkIndex % m_chunkCountX;
+        int64_t chunkY = chunkIndex / m_chunkCountX;
+        int64_t distanceX = std::max<int64_t>({visibleChunks.firstX - chunkX, chunkX - visibleChunks.lastX, 0});
+        int64_t distanceY = std::max<int64_t>({visibleChunks.firstY - chunkY, chunkY - visibleChunks.lastY, 0});
+        return std::max(distanceX, distanceY);
+    };
+
+    // Add the chunks read since the last update, unless the camera went away
+    std::vector<std::pair<uint32_t, std::shared_ptr<TileChunk>>> streamedChunks;
+    {
+        std::lock_guard<std::mutex> lock(m_streamedChunks->mutex);
+        streamedChunks.swap(m_streamedChunks->chunks);
+    }
+
+    for(auto& [chunkIndex, tileChunk] : streamedChunks)
+    {
+        m_loadingChunkCount--;
+        Chunk& chunk = m_chunks[chunkIndex];
+        if(!tileChunk)
+        {
+            chunk.retryDelay = chunk.retryDelay == 0.f ? STREAMING_RETRY_DELAY
+                : std::min(chunk.retryDelay * 2.f, MAX_STREAMING_RETRY_DELAY);
+            chunk.retryTimer = chunk.retryDelay;
+            chunk.state = ChunkState::Failed;
+            m_failedChunks.push_back(chunkIndex);
+            SPDLOG_WARN("[GameGrid] Failed to read the chunk ({}, {}), retrying in {:.0f} s",
+                chunkIndex % m_chunkCountX, chunkIndex / m_chunkCountX, chunk.retryDelay);
+            continue;
+        }
+        chunk.retryDelay = 0.f;
+
+        if(getDistance(chunkIndex) > STREAMING_RELEASE_MARGIN)
+        {
+            chunk.state = ChunkState::Unloaded;
+            continue;
+        }
+
+        m_loadedTileSize += tileChunk->GetMemorySize();
+        m_tileChunks[chunkIndex] = std::move(tileChunk);
+        m_loadedChunks.push_back(chunkIndex);
+        AddChunkTiles(chunkIndex);
+
+        chunk.state = ChunkState::Loaded;
+        chunk.dirty = true;
+        m_dirtyChunks.push_back(chunkIndex);
+    }
+
+    // The failed chunks can be requested again once their delay is elapsed
+    std::erase_if(m_failedChunks, [this, deltaTime](uint32_t chunkIndex)
+    {
+        Chunk& chunk = m_chunks[chunkIndex];
+        chunk.retryTimer -= deltaTime;
+        if(chunk.retryTimer > 0.f)
+        {
+            return false;
+        }
+
+        chunk.state = ChunkState::Unloaded;
+        return true;
+    });
+
+    // Release the chunks far from the view, and the farthest chunks outside
+    // of the load ring while the budget is exceeded
+    std::sort(m_loadedChunks.begin(), m_loadedChunks.end(), [&getDistance](uint32_t a, uint32_t b)
+    {
+        return getDistance(a) > getDistance(b);
+    });
+
+    uint32_t releasedCount = 0;
+    for(uint32_t chunkIndex : m_loadedChunks)
+    {
+        int64_t distance = getDistance(chunkIndex);
+        if(distance <= STREAMING_LOAD_MARGIN)
+        {
+            break;
+        }
+
+        // The unsaved chunks cannot be read again
+        const Chunk& chunk = m_chunks[chunkIndex];
+        bool overBudget = m_loadedTileSize + m_geometrySize > m_streamingBudget;
+        if(!chunk.modified && !chunk.saving && (distance > STREAMING_RELEASE_MARGIN || overBudget))
+        {
+            ReleaseChunk(chunkIndex);
+            releasedCount++;
+        }
+    }
+
+    if(releasedCount > 0)
+    {
+        std::erase_if(m_loadedChunks, [this](uint32_t chunkIndex)
+        {
+            return m_chunks[chunkIndex].state != ChunkState::Loaded;
+        });
+        SPDLOG_DEBUG("[GameGrid] Released {} chunks, {} chunks loaded, {} KiB", releasedCount, m_loadedChunks.size(),
+            (m_loadedTileSize + m_geometrySize) / 1024);
+    }
+
+    // Request the missing chunks around the view, the closest first
+    int64_t firstX = std::max<int64_t>(visibleChunks.firstX - STREAMING_LOAD_MARGIN, 0);
+    int64_t firstY = std::max<int64_t>(visibleChunks.firstY - STREAMING_LOAD_MARGIN, 0);
+    int64_t lastX = std::min<int64_t>(visibleChunks.lastX + STREAMING_LOAD_MARGIN, static_cast<int64_t>(m_chunkCountX) - 1);
+    int64_t lastY = std::min<int64_t>(visibleChunks.lastY + STREAMING_LOAD_MARGIN, static_cast<int64_t>(m_chunkCountY) - 1);
+
+    std::vector<uint32_t> missingChunks;
+    for(int64_t chunkY = firstY; chunkY <= lastY; chunkY++)
+    {
+        for(int64_t chunkX = firstX; chunkX <= lastX; chunkX++)
+        {
+            auto chunkIndex = static_cast<uint32_t>(chunkY * m_chunkCountX + chunkX);
+            if(m_chunks[chunkIndex].state == ChunkState::Unloaded)
+            {
+                missingChunks.push_back(chunkIndex);
+            }
+        }
+    }
+    std::sort(missingChunks.begin(), missingChunks.end(), [&getDistance](uint32_t a, uint32_t b)
+    {
+        return getDistance(a) < getDistance(b);
+    });
+
+    // While the budget is exceeded, only the visible chunks are read
+    ThreadPool& threadPool = Application::GetInstance().GetThreadPool();
+    bool overBudget = m_loadedTileSize + m_geometrySize > m_streamingBudget;
+    for(uint32_t chunkIndex : missingChunks)
+    {
+        if(m_loadingChunkCount >= MAX_STREAMING_LOADS || (overBudget && getDistance(chunkIndex) > 0))
+        {
+            break;
+        }
+
+        m_chunks[chunkIndex].state = ChunkState::Loading;
+        m_loadingChunkCount++;
+
+        // The task keeps the stream alive if the grid is destroyed first
+        threadPool.Enqueue([stream = m_stream, streamedChunks = m_streamedChunks, chunkIndex]()
+        {
+            std::shared_ptr<TileChunk> tileChunk = stream->LoadChunk(chunkIndex % stream->GetChunkCountX(),
+                                                                     chunkIndex / stream->GetChunkCountX());
+
+            std::lock_guard<std::mutex> lock(streamedChunks->mutex);
+            streamedChunks->chunks.emplace_back(chunkIndex, std::move(tileChunk));
+        });
+    }
+}
+
+void GameGrid::ReleaseChunk(uint32_t chunkIndex)
+{
+    RemoveChunkTiles(chunkIndex);
+    m_loadedTileSize -= m_tileChunks[chunkIndex]->GetMemorySize();
+    m_tileChunks[chunkIndex] = m_unloadedChunk;
+
+    Chunk& chunk = m_chunks[chunkIndex];
+    m_geometrySize -= (m_useVertexBuffers ? chunk.vertexBuffer.getVertexCount() : chunk.vertexArray.getVertexCount())
+        * sizeof(sf::Vertex);
+    chunk.vertexBuffer = sf::VertexBuffer(sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Static);
+    chunk.vertexArray.clear();
+
+    // The chunk may have been added during this update
+    if(chunk.dirty)
+    {
+        std::erase(m_dirtyChunks, chunkIndex);
+    }
+    chunk.dirty = false;
+    chunk.dirtyTiles.clear();
+    chunk.state = ChunkState::Unloaded;
+}
+
+bool GameGrid::SetTile(uint32_t x, uint32_t y, TileType type, uint16_t textureIndex,
+                       const uint8_t* data, uint32_t size)
+{
+    if(type > TileType::Soil)
+    {
+        throw std::runtime_error("[GameGrid] Unknown tile type " + std::to_string(static_cast<int>(type)));
+    }
+
+    if(!IsTileLoaded(x, y))
+    {
+        throw std::runtime_error("[GameGrid] The tile (" + std::to_string(x) + ", " + std::to_string(y) + ") is not loaded");
+    }
+
+    // The data is checked before the chunk is modified, so an invalid tile is never written
+    bool valid = true;
+    SoilData soil;
+    if(type == TileType::PassagePoint)
+    {
+        PassagePointData passagePoint;
+        valid = PassagePointTile::ParseData(data, size, passagePoint);
+    }
+    else if(type == TileType::Soil)
+    {
+        valid = SoilTile::ParseData(data, size, soil);
+    }
 
-    // Open the file and read the header
-    std::ifstream file(path, std::ios::binary);
-    if(!file.is_open())
+    if(!valid)
+    {
+        SPDLOG_ERROR("[GameGrid] Invalid data for the tile ({}, {}) of type {}", x, y, static_cast<int>(type));
+        return false;
+    }
+
+    // The previous tile stops being updated, the new one is updated if it has something to update
+    uint64_t tile = static_cast<uint64_t>(y) * m_width + x;
+    m_scheduler.Deactivate(GetTileType(x, y), tile);
+    GetMutableChunk(x, y).SetTile(TileChunk::GetCell(x, y), type, textureIndex, data, size);
+    if(type == TileType::Soil && SoilTile::IsActive(soil))
+    {
+        m_scheduler.Activate(TileType::Soil, tile);
+    }
+    UpdateTileMasks(x, y);
+    m_chunkVersions[(y / CHUNK_SIZE) * m_chunkCountX + x / CHUNK_SIZE]++;
+    m_version++;
+
+    // Only the vertices of this tile need to be sent again
+    MarkTileDirty(x, y);
+    return true;
+}
+
+SoilData* GameGrid::GetSoil(uint32_t x, uint32_t y)
+{
+    // Do not copy the chunk if there is nothing to modify
+    if(GetChunk(x, y).soil.count(TileChunk::GetCell(x, y)) == 0)
     {
         return nullptr;
     }
 
-    auto* grid = new RawGameGrid;
-    file.read(reinterpret_cast<char*>(grid), sizeof(RawGameGrid));
+    // The caller may water the soil, it will be deactivated on its next
+    // tick if there is nothing to update
+    m_scheduler.Activate(TileType::Soil, static_cast<uint64_t>(y) * m_width + x);
+
+    return &GetMutableChunk(x, y).soil.at(TileChunk::GetCell(x, y));
+}
+
+const PassagePointData* GameGrid::GetPassagePoint(uint32_t x, uint32_t y) const
+{
+    const TileChunk& chunk = GetChunk(x, y);
+
+    auto iterator = chunk.passagePoints.find(TileChunk::GetCell(x, y));
+    return iterator != chunk.passagePoints.end() ? &iterator->second : nullptr;
+}
+
+void GameGrid::GetPassagePoints(uint32_t chunkIndex, std::vector<std::pair<sf::Vector2u, PassagePointData>>& passagePoints) const
+{
+    passagePoints.clear();
+    uint32_t firstX = (chunkIndex % m_chunkCountX) * CHUNK_SIZE;
+    uint32_t firstY = (chunkIndex / m_chunkCountX) * CHUNK_SIZE;
+    for(const auto& [cell, passagePoint] : m_tileChunks[chunkIndex]->passagePoints)
+    {
+        passagePoints.emplace_back(sf::Vector2u(firstX + cell % CHUNK_SIZE, firstY + cell / CHUNK_SIZE), passagePoint);
+    }
+}
+
+bool GameGrid::IsDestinationLoaded(const std::string& tilemap) const
+{
+    auto iterator = m_destinations.find(tilemap);
+    return iterator != m_destinations.end() && iterator->second.loaded;
+}
+
+void GameGrid::UpdateDestinations()
+{
+    // Find the destinations of the passage points near the camera, in the
+    // loaded chunks around it
+    sf::Vector2f center = GetCameraCenter();
+    auto centerX = static_cast<int64_t>(std::floor(center.x));
+    auto centerY = static_cast<int64_t>(std::floor(center.y));
+    auto distance = static_cast<int64_t>(PASSAGE_PREFETCH_DISTANCE);
+
+    int64_t firstChunkX = std::max<int64_t>(centerX - distance, 0) / CHUNK_SIZE;
+    int64_t firstChunkY = std::max<int64_t>(centerY - distance, 0) / CHUNK_SIZE;
+    int64_t lastChunkX = std::min<int64_t>(centerX + distance, static_cast<int64_t>(m_width) - 1) / CHUNK_SIZE;
+    int64_t lastChunkY = std::min<int64_t>(centerY + distance, static_cast<int64_t>(m_height) - 1) / CHUNK_SIZE;
+
+    std::unordered_set<std::string> nearbyDestinations;
+    for(int64_t chunkY = firstChunkY; chunkY <= lastChunkY; chunkY++)
+    {
+        for(int64_t chunkX = firstChunkX; chunkX <= lastChunkX; chunkX++)
+        {
+            for(const auto& [cell, passagePoint] : m_tileChunks[chunkY * m_chunkCountX + chunkX]->passagePoints)
+            {
+                int64_t x = chunkX * CHUNK_SIZE + cell % CHUNK_SIZE;
+                int64_t y = chunkY * CHUNK_SIZE + cell / CHUNK_SIZE;
+                if(!passagePoint.tilemap.empty() && std::abs(x - centerX) <= distance && std::abs(y - centerY) <= distance)
+                {
+                    nearbyDestinations.insert(passagePoint.tilemap);
+                }
+            }
+        }
+    }
+
+    // Keep the destinations loaded since the last update
+    std::vector<std::pair<std::string, Destination>> loadedDestinations;
+    {
+        std::lock_guard<std::mutex> lock(m_loadedDestinations->mutex);
+        loadedDestinations.swap(m_loadedDestinations->destinations);
+    }
+
+    for(auto& [tilemap, destination] : loadedDestinations)
+    {
+        m_destinations[tilemap] = std::move(destination);
+    }
+
+    // The destinations being loaded are released once they are loaded
+    std::erase_if(m_destinations, [&nearbyDestinations](const auto& element)
+    {
+        const auto& [tilemap, destination] = element;
+        return (destination.loaded || destination.failed) && nearbyDestinations.count(tilemap) == 0;
+    });
+
+    ThreadPool& threadPool = Application::GetInstance().GetThreadPool();
+    for(const std::string& tilemap : nearbyDestinations)
+    {
+        if(!m_destinations.try_emplace(tilemap).second)
+        {
+            continue;
+        }
+
+        // The tileset is loaded on the thread as well, which shares the OpenGL
+        // context of the main thread
+        threadPool.Enqueue([loadedDestinations = m_loadedDestinations, tilemap]()
+        {
+            Destination destination;
+            sf::Clock clock;
+            try
+            {
+                Application& application = Application::GetInstance();
+                destination.tilemap = application.GetTilemapRegistry().GetResource(tilemap);
+                destination.tileset = application.GetTilesetRegistry().GetResource(destination.tilemap->GetTilesetPath());
+                destination.loaded = true;
+
+                SPDLOG_DEBUG("[GameGrid] Loaded the destination {} in {} ms", tilemap, clock.getElapsedTime().asMilliseconds());
+            }
+            catch(const std::exception& exception)
+            {
+                // It is not requested again while the camera stays close to it
+                destination.failed = true;
+                SPDLOG_WARN("[GameGrid] Failed to load the destination {}: {}", tilemap, exception.what());
+            }
+
+            std::lock_guard<std::mutex> lock(loadedDestinations->mutex);
+            loadedDestinations->destinations.emplace_back(tilemap, std::move(destination));
+        });
+    }
+}
+
+TileChunk& GameGrid::GetMutableChunk(uint32_t x, uint32_t y)
+{
+    uint32_t chunkIndex = (y / CHUNK_SIZE) * m_chunkCountX + x / CHUNK_SIZE;
+    std::shared_ptr<TileChunk>& chunk = m_tileChunks[chunkIndex];
+    Chunk& state = m_chunks[chunkIndex];
+
+    // The chunk is shared with the tilemap, another grid or a save, copy it before the first modification.
+    // The use count cannot tell if the save still reads the chunk, as the thread pool releases its
+    // snapshot without synchronizing with this thread: the first modification of a chunk being
+    // saved always copies it, the chunk is not shared with the save after that
+    if((state.saving && !state.modified) || chunk.use_count() > 1)
+    {
+        chunk = std::make_shared<TileChunk>(*chunk);
+    }
+
+    if(!state.modified)
+    {
+        state.modified = true;
+        m_modifiedChunks.push_back(chunkIndex);
+    }
+
+    return *chunk;
+}
+
+uint32_t GameGrid::Save()
+{
+    // The journal is written by one save at a time
+    if(m_saveTask != nullptr)
+    {
+        bool saved;
+        {
+            std::unique_lock<std::mutex> lock(m_saveTask->mutex);
+            m_saveTask->condition.wait(lock, [this]()
+            {
+                return m_saveTask->finished;
+            });
+            saved = m_saveTask->saved;
+        }
+        m_saveTask.reset();
+        FinishSave(saved);
+    }
+
+    if(m_modifiedChunks.empty())
+    {
+        return 0;
+    }
+
+    if(!CanSave())
+    {
+        throw std::runtime_error("[GameGrid] The journal of " + m_path + " cannot be written");
+    }
+
+    std::vector<TilemapJournal::SavedChunk> chunks = TakeSnapshot();
+    bool saved = m_journal->Append(chunks);
+    FinishSave(saved);
+    if(!saved)
+    {
+        throw std::runtime_error("[GameGrid] Failed to save " + std::to_string(chunks.size()) + " chunks");
+    }
+
+    return static_cast<uint32_t>(chunks.size());
+}
+
+bool GameGrid::SaveAsync()
+{
+    if(m_saveTask != nullptr || !CanSave())
+    {
+        return false;
+    }
+
+    if(m_modifiedChunks.empty())
+    {
+        return true;
+    }
+
+    // The task only accesses the snapshot, the journal and its result
+    auto task = std::make_shared<SaveTask>();
+    auto write = [journal = m_journal, task, chunks = TakeSnapshot()]()
+    {
+        bool saved = journal->Append(chunks);
+
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->finished = true;
+        task->saved = saved;
+        task->condition.notify_all();
+    };
+    m_saveTask = task;
+
+    // Without threads, the task would never be run
+    ThreadPool& threadPool = Application::GetInstance().GetThreadPool();
+    if(threadPool.GetThreadCount() == 0)
+    {
+        write();
+    }
+    else
+    {
+        threadPool.Enqueue(std::move(write));
+    }
+
+    return true;
+}
+
+void GameGrid::UpdateSave(float deltaTime)
+{
+    if(m_saveTask != nullptr)
+    {
+        std::unique_lock<std::mutex> lock(m_saveTask->mutex);
+        if(m_saveTask->finished)
+        {
+            bool saved = m_saveTask->saved;
+            lock.unlock();
+            m_saveTask.reset();
+            FinishSave(saved);
+        }
+    }
+
+    if(m_autosaveInterval <= 0.f || !CanSave())
+    {
+        return;
+    }
+
+    // The timer keeps running while the previous save is written
+    m_autosaveTimer += deltaTime;
+    if(m_autosaveTimer >= m_autosaveInterval && SaveAsync())
+    {
+        m_autosaveTimer = 0.f;
+    }
+}
+
+std::vector<TilemapJournal::SavedChunk> GameGrid::TakeSnapshot()
+{
+    // Sharing the chunks is enough, the next modification of a chunk copies it
+    std::vector<TilemapJournal::SavedChunk> chunks;
+    chunks.reserve(m_modifiedChunks.size());
+    for(uint32_t chunkIndex : m_modifiedChunks)
+    {
+        Chunk& chunk = m_chunks[chunkIndex];
+        chunk.modified = false;
+        chunk.saving = true;
+        chunks.push_back({chunkIndex % m_chunkCountX, chunkIndex / m_chunkCountX, m_tileChunks[chunkIndex]});
+    }
+
+    m_savingChunks = std::move(m_modifiedChunks);
+    m_modifiedChunks.clear();
+    return chunks;
+}
 
-    // Calculate the size of the data
-    uint32_t dataSize = grid->tilesetPathSize + grid->tilesSize + grid->entitiesSize;
+void GameGrid::FinishSave(bool saved)
+{
+    // The saved chunks can now be released and read again, unless they were
+    // modified during the save
+    for(uint32_t chunkIndex : m_savingChunks)
+    {
+        Chunk& chunk = m_chunks[chunkIndex];
+        chunk.saving = false;
+        if(!saved && !chunk.modified)
+        {
+            chunk.modified = true;
+            m_modifiedChunks.push_back(chunkIndex);
+        }
+    }
 
+    // The tilemap in the registry does not contain the saved chunks, the next
+    // grids parse the file and the journal again
+    if(saved && !m_savingChunks.empty())
     {
-        auto* newGrid = (RawGameGrid*)malloc(sizeof(RawGameGrid) + dataSize);
-        std::memcpy(newGrid, grid, sizeof(RawGameGrid));
-        grid = newGrid;
+        Application::GetInstance().GetTilemapRegistry().Invalidate(m_path);
     }
-    // Read the remaining data
-    file.read(reinterpret_cast<char*>(grid->data), dataSize);
+    m_savingChunks.clear();
+}
 
-    // Reserve enough space to store all tiles
-    tiles.reserve(grid->width * grid->height);
+bool GameGrid::IsAreaWalkable(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const
+{
+    x = std::min(x, m_width);
+    y = std::min(y, m_height);
+    return m_walkableTiles.All(x, y, std::min(width, m_width - x), std::min(height, m_height - y));
+}
+
+uint64_t GameGrid::CountPlantableTiles(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const
+{
+    x = std::min(x, m_width);
+    y = std::min(y, m_height);
+    return m_plantableTiles.Count(x, y, std::min(width, m_width - x), std::min(height, m_height - y));
+}
 
-    // Get the tileset path (it is the first field in data)
-    std::string tilesetPath(reinterpret_cast<char*>(grid->data), grid->tilesetPathSize);
+void GameGrid::UpdateTileMasks(uint32_t x, uint32_t y)
+{
+    uint8_t flags = GetTileFlags(x, y);
 
-    // Parse tiles
-    auto* rawTile = (RawGameTile*)(grid->data + grid->tilesetPathSize);
-    while(rawTile < (RawGameTile*)(grid->data + grid->tilesetPathSize + grid->tilesSize))
+    uint8_t cost = MOVEMENT_COST_NORMAL;
+    if(flags & TileChunk::FLAG_SOLID)
+    {
+        cost = 0;
+    }
+    else if(flags & TileChunk::FLAG_FAST)
+    {
+        cost = MOVEMENT_COST_FAST;
+    }
+    else if(flags & TileChunk::FLAG_SLOW)
     {
-        tiles.push_back(Tile::ParseRawTile(rawTile));
-        rawTile = (RawGameTile*)((uint8_t*)rawTile + rawTile->size);
+        cost = MOVEMENT_COST_SLOW;
     }
 
-    // TODO: parse entities
+    m_walkableTiles.Set(x, y, cost != 0);
+    m_plantableTiles.Set(x, y, GetTileType(x, y) == TileType::Soil);
+    m_movementCosts[static_cast<size_t>(y) * m_width + x] = cost;
+}
+
+void GameGrid::UpdateTiles(float deltaTime)
+{
+    // Only the types with a behavior are dispatched, and only their active
+    // tiles are updated
+    uint32_t ticks = m_scheduler.Advance(TileType::Soil, deltaTime);
+    if(ticks > 0)
+    {
+        // A dry soil does not change, so its chunk is not copied or saved again. Going
+        // backwards, as a deactivated tile is replaced by the last one
+        const std::vector<uint64_t>& tiles = m_scheduler.GetActiveTiles(TileType::Soil);
+        for(size_t i = tiles.size(); i-- > 0;)
+        {
+            auto x = static_cast<uint32_t>(tiles[i] % m_width);
+            auto y = static_cast<uint32_t>(tiles[i] / m_width);
+            if(!SoilTile::IsActive(GetChunk(x, y).soil.at(TileChunk::GetCell(x, y))))
+            {
+                m_scheduler.Deactivate(TileType::Soil, tiles[i]);
+            }
+        }
 
-    return std::unique_ptr<GameGrid>(new GameGrid(std::move(tiles), tilesetPath, grid->width, grid->height));
+        // Gather the moist soils, so the system updates them in one batch
+        m_soilBatch.clear();
+        for(uint64_t tile : tiles)
+        {
+            auto x = static_cast<uint32_t>(tile % m_width);
+            auto y = static_cast<uint32_t>(tile / m_width);
+            m_soilBatch.push_back(&GetMutableChunk(x, y).soil.at(TileChunk::GetCell(x, y)));
+        }
+
+        SoilTile::Update(m_soilBatch.data(), m_soilBatch.size(), ticks);
+
+        // Going backwards, as a deactivated tile is replaced by the last one
+        for(size_t i = m_soilBatch.size(); i-- > 0;)
+        {
+            if(!SoilTile::IsActive(*m_soilBatch[i]))
+            {
+                m_scheduler.Deactivate(TileType::Soil, tiles[i]);
+            }
+        }
+    }
 }
 
-GameGrid::GameGrid(std::vector<std::unique_ptr<Tile>>&& tiles, const std::string& tileset, int width, int height)
-    : m_width(width), m_height(height), m_tiles(std::move(tiles))
+void GameGrid::MarkTileDirty(uint32_t x, uint32_t y)
 {
-    m_tilesetTexture = Application::GetInstance().GetTextureRegistry().GetResource(tileset.c_str());
+    std::lock_guard<std::mutex> lock(m_chunksMutex);
+
+    uint32_t chunkX = x / CHUNK_SIZE;
+    uint32_t chunkY = y / CHUNK_SIZE;
+    Chunk& chunk = m_chunks[chunkY * m_chunkCountX + chunkX];
+
+    // The whole chunk will be rebuilt anyway
+    if(chunk.dirty)
+    {
+        return;
+    }
+
+    if(chunk.dirtyTiles.empty())
+    {
+        m_patchedChunks.push_back(chunkY * m_chunkCountX + chunkX);
+    }
+
+    // The index of the tile in the chunk, which is also the index of
+    // its vertices in the chunk geometry (divided by 6)
+    uint32_t chunkWidth = std::min(CHUNK_SIZE, m_width - chunkX * CHUNK_SIZE);
+    chunk.dirtyTiles.push_back((y - chunkY * CHUNK_SIZE) * chunkWidth + x - chunkX * CHUNK_SIZE);
 }
 
 void GameGrid::Update(float deltaTime)
 {
-    if(m_shouldUpdateVertexArray)
+    UpdateTiles(deltaTime);
+    UpdateDestinations();
+    UpdateSave(deltaTime);
+
+    std::lock_guard<std::mutex> lock(m_chunksMutex);
+
+    if(m_requestedRenderMode != m_renderMode)
+    {
+        SwitchRenderMode();
+    }
+
+    if(m_stream)
+    {
+        UpdateStreaming(deltaTime);
+    }
+
+    if(m_renderMode == RenderMode::Shader)
+    {
+        // Only the indices of the modified tiles are sent
+        for(uint32_t chunkIndex : m_dirtyChunks)
+        {
+            uint32_t firstX = (chunkIndex % m_chunkCountX) * CHUNK_SIZE;
+            uint32_t firstY = (chunkIndex / m_chunkCountX) * CHUNK_SIZE;
+            UploadTileIndices(
+                firstX, firstY,
+                std::min(CHUNK_SIZE, m_width - firstX), std::min(CHUNK_SIZE, m_height - firstY)
+            );
+
+            m_chunks[chunkIndex].dirty = false;
+            m_chunks[chunkIndex].dirtyTiles.clear();
+        }
+        m_dirtyChunks.clear();
+
+        // The modified tiles of a chunk are sent as a single rectangle
+        for(uint32_t chunkIndex : m_patchedChunks)
+        {
+            std::vector<uint32_t>& tiles = m_chunks[chunkIndex].dirtyTiles;
+            if(tiles.empty())
+            {
+                continue;
+            }
+
+            uint32_t firstX = (chunkIndex % m_chunkCountX) * CHUNK_SIZE;
+            uint32_t firstY = (chunkIndex / m_chunkCountX) * CHUNK_SIZE;
+            uint32_t chunkWidth = std::min(CHUNK_SIZE, m_width - firstX);
+
+            uint32_t minX = CHUNK_SIZE, minY = CHUNK_SIZE, maxX = 0, maxY = 0;
+            for(uint32_t tile : tiles)
+            {
+                minX = std::min(minX, tile % chunkWidth);
+                maxX = std::max(maxX, tile % chunkWidth);
+                minY = std::min(minY, tile / chunkWidth);
+                maxY = std::max(maxY, tile / chunkWidth);
+            }
+
+            UploadTileIndices(firstX + minX, firstY + minY, maxX - minX + 1, maxY - minY + 1);
+            tiles.clear();
+        }
+        m_patchedChunks.clear();
+
+        return;
+    }
+
+    // Only rebuild the chunks that were modified
+    // The vertices of a batch of chunks are created in parallel, each chunk
+    // writing in its own list, then uploaded by this thread which owns the
+    // OpenGL context
+    sf::Clock clock;
+    ThreadPool& threadPool = Application::GetInstance().GetThreadPool();
+    size_t threadCount = 1;
+    for(size_t batchStart = 0; batchStart < m_dirtyChunks.size(); batchStart += REBUILD_BATCH_SIZE)
+    {
+        size_t batchSize = std::min<size_t>(REBUILD_BATCH_SIZE, m_dirtyChunks.size() - batchStart);
+        m_chunkVertices.resize(std::max(m_chunkVertices.size(), batchSize));
+
+        size_t batchThreadCount = threadPool.ParallelFor(batchSize, 1, [this, batchStart](size_t begin, size_t end)
+        {
+            for(size_t i = begin; i < end; i++)
+            {
+                uint32_t chunkIndex = m_dirtyChunks[batchStart + i];
+                CreateChunkVertices(chunkIndex % m_chunkCountX, chunkIndex / m_chunkCountX, m_chunkVertices[i]);
+            }
+        });
+        threadCount = std::max(threadCount, batchThreadCount);
+
+        for(size_t i = 0; i < batchSize; i++)
+        {
+            Chunk& chunk = m_chunks[m_dirtyChunks[batchStart + i]];
+            UploadChunk(chunk, m_chunkVertices[i]);
+            chunk.dirty = false;
+            chunk.dirtyTiles.clear();
+        }
+    }
+
+    if(m_dirtyChunks.size() > 1)
+    {
+        SPDLOG_DEBUG("[GameGrid] Rebuilt {} chunks in {} us on {} threads",
+            m_dirtyChunks.size(), clock.getElapsedTime().asMicroseconds(), threadCount);
+    }
+    m_dirtyChunks.clear();
+
+    std::vector<sf::Vertex> vertices;
+
+    // Then patch the chunks in which only a few tiles were modified
+    for(uint32_t chunkIndex : m_patchedChunks)
+    {
+        if(!m_chunks[chunkIndex].dirtyTiles.empty())
+        {
+            PatchChunk(chunkIndex, vertices);
+        }
+    }
+    m_patchedChunks.clear();
+}
+
+void GameGrid::PatchChunk(uint32_t chunkIndex, std::vector<sf::Vertex>& vertices)
+{
+    Chunk& chunk = m_chunks[chunkIndex];
+    uint32_t firstX = (chunkIndex % m_chunkCountX) * CHUNK_SIZE;
+    uint32_t firstY = (chunkIndex / m_chunkCountX) * CHUNK_SIZE;
+    uint32_t chunkWidth = std::min(CHUNK_SIZE, m_width - firstX);
+
+    // Sort the modified tiles so that neighbors can be sent together
+    std::vector<uint32_t>& tiles = chunk.dirtyTiles;
+    std::sort(tiles.begin(), tiles.end());
+    tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+
+    size_t runStart = 0;
+    while(runStart < tiles.size())
+    {
+        // Extend the range while the next modified tile is close enough, sending
+        // a few unmodified tiles is cheaper than another upload
+        size_t runEnd = runStart + 1;
+        while(runEnd < tiles.size() && tiles[runEnd] - tiles[runEnd - 1] <= MAX_PATCH_GAP + 1)
+        {
+            runEnd++;
+        }
+
+        uint32_t firstTile = tiles[runStart];
+        uint32_t tileCount = tiles[runEnd - 1] - firstTile + 1;
+
+        vertices.resize(static_cast<size_t>(tileCount) * 6);
+        for(uint32_t i = 0; i < tileCount; i++)
+        {
+            uint32_t tile = firstTile + i;
+            WriteTileVertices(firstX + tile % chunkWidth, firstY + tile / chunkWidth, &vertices[i * 6]);
+        }
+
+        if(m_useVertexBuffers)
+        {
+            if(!chunk.vertexBuffer.update(vertices.data(), vertices.size(), firstTile * 6))
+            {
+                throw std::runtime_error("[GameGrid] Failed to update a vertex buffer");
+            }
+        }
+        else
+        {
+            for(size_t i = 0; i < vertices.size(); i++)
+            {
+                chunk.vertexArray[firstTile * 6 + i] = vertices[i];
+            }
+        }
+
+        runStart = runEnd;
+    }
+
+    tiles.clear();
+}
+
+void GameGrid::UploadChunk(Chunk& chunk, const std::vector<sf::Vertex>& vertices)
+{
+    if(m_useVertexBuffers)
+    {
+        m_geometrySize -= chunk.vertexBuffer.getVertexCount() * sizeof(sf::Vertex);
+        m_geometrySize += vertices.size() * sizeof(sf::Vertex);
+
+        // Only reallocate the buffer when the number of tiles changes
+        if(chunk.vertexBuffer.getVertexCount() != vertices.size() && !chunk.vertexBuffer.create(vertices.size()))
+        {
+            throw std::runtime_error("[GameGrid] Failed to create a vertex buffer");
+        }
+
+        if(!chunk.vertexBuffer.update(vertices.data()))
+        {
+            throw std::runtime_error("[GameGrid] Failed to update a vertex buffer");
+        }
+    }
+    else
+    {
+        m_geometrySize -= chunk.vertexArray.getVertexCount() * sizeof(sf::Vertex);
+        m_geometrySize += vertices.size() * sizeof(sf::Vertex);
+
+        chunk.vertexArray.resize(vertices.size());
+        for(size_t i = 0; i < vertices.size(); i++)
+        {
+            chunk.vertexArray[i] = vertices[i];
+        }
+    }
+}
+
+void GameGrid::SwitchRenderMode()
+{
+    if(m_requestedRenderMode == RenderMode::Shader && !PrepareShaderRenderer())
+    {
+        m_requestedRenderMode = RenderMode::Vertices;
+        return;
+    }
+
+    // Release the memory of the previous mode
+    if(m_requestedRenderMode == RenderMode::Shader)
+    {
+        for(Chunk& chunk : m_chunks)
+        {
+            chunk.vertexBuffer = sf::VertexBuffer(sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Static);
+            chunk.vertexArray.clear();
+        }
+        m_geometrySize = 0;
+    }
+    else
+    {
+        m_tilemapShader.reset();
+        m_tileIndices.reset();
+        m_tileIndexPixels = std::vector<uint8_t>();
+    }
+
+    m_renderMode = m_requestedRenderMode;
+    SPDLOG_INFO("[GameGrid] Switched to the {} render mode", m_renderMode == RenderMode::Shader ? "shader" : "vertices");
+
+    // Everything needs to be sent again
+    m_dirtyChunks.clear();
+    m_patchedChunks.clear();
+    for(uint32_t i = 0; i < m_chunks.size(); i++)
+    {
+        m_chunks[i].dirty = true;
+        m_chunks[i].dirtyTiles.clear();
+        m_dirtyChunks.push_back(i);
+    }
+}
+
+bool GameGrid::PrepareShaderRenderer()
+{
+    if(m_stream)
+    {
+        SPDLOG_WARN("[GameGrid] A streamed grid is drawn with vertices");
+        return false;
+    }
+
+    if(!sf::Shader::isAvailable())
+    {
+        SPDLOG_WARN("[GameGrid] Shaders are not available, the grid is drawn with vertices");
+        return false;
+    }
+
+    unsigned int maximumSize = sf::Texture::getMaximumSize();
+    if(m_width > maximumSize || m_height > maximumSize)
+    {
+        SPDLOG_WARN("[GameGrid] The grid ({}x{}) is bigger than the maximum texture size ({}), it is drawn with vertices",
+            m_width, m_height, maximumSize);
+        return false;
+    }
+
+    auto tileIndices = std::make_unique<sf::Texture>();
+    if(!tileIndices->create({m_width, m_height}))
+    {
+        SPDLOG_WARN("[GameGrid] Failed to create the tile indices texture, the grid is drawn with vertices");
+        return false;
+    }
+
+    // The indices must be read as they are, without filtering
+    tileIndices->setSmooth(false);
+
+    auto shader = std::make_unique<sf::Shader>();
+    if(!shader->loadFromMemory(TILEMAP_VERTEX_SHADER, TILEMAP_FRAGMENT_SHADER))
+    {
+        SPDLOG_WARN("[GameGrid] Failed to compile the tilemap shader, the grid is drawn with vertices");
+        return false;
+    }
+
+    const sf::Texture& tileset = m_tileset->GetTexture();
+    shader->setUniform("tileIndices", *tileIndices);
+    shader->setUniform("tileset", tileset);
+    shader->setUniform("mapSize", sf::Vector2f(static_cast<float>(m_width), static_cast<float>(m_height)));
+    shader->setUniform("tilesetSize", sf::Vector2f(tileset.getSize()));
+    shader->setUniform("columns", static_cast<float>(m_tileset->GetColumnCount()));
+    shader->setUniform("tileSize", static_cast<float>(Tileset::TILE_SIZE));
+    shader->setUniform("cellSize", static_cast<float>(Tileset::CELL_SIZE));
+    shader->setUniform("gutter", static_cast<float>(Tileset::GUTTER));
+
+    m_tileIndices = std::move(tileIndices);
+    m_tilemapShader = std::move(shader);
+    return true;
+}
+
+void GameGrid::UploadTileIndices(uint32_t firstX, uint32_t firstY, uint32_t width, uint32_t height)
+{
+    m_tileIndexPixels.resize(static_cast<size_t>(width) * height * 4);
+
+    uint8_t* pixel = m_tileIndexPixels.data();
+    for(uint32_t y = firstY; y < firstY + height; y++)
     {
-        // Update the vertex array
-        m_vertexArrayMutex.lock();
-        m_vertexArray = std::move(CreateVertexArray());
-        m_vertexArrayMutex.unlock();
-        m_shouldUpdateVertexArray = false;
+        for(uint32_t x = firstX; x < firstX + width; x++)
+        {
+            uint16_t textureIndex = GetTextureIndex(x, y);
+            // The texture indices have 16 bits, the blue channel is unused
+            pixel[0] = static_cast<uint8_t>(textureIndex);
+            pixel[1] = static_cast<uint8_t>(textureIndex >> 8);
+            pixel[2] = 0;
+            pixel[3] = 255;
+            pixel += 4;
+        }
     }
+
+    m_tileIndices->update(m_tileIndexPixels.data(), {width, height}, {firstX, firstY});
 }
 
 void GameGrid::Render(sf::RenderWindow& window)
 {
     sf::RenderStates states;
-    states.texture = m_tilesetTexture.GetPointer();
+    states.texture = &m_tileset->GetTexture();
+    states.transform = GetCameraTransform();
+
+    // Find the part of the grid seen by the camera, by transforming the
+    // window back to the coordinates of the grid
+    sf::FloatRect view = states.transform.getInverse().transformRect(sf::FloatRect(
+        {0, 0},
+        {static_cast<float>(Application::WINDOW_WIDTH), static_cast<float>(Application::WINDOW_HEIGHT)}
+    ));
+
+    // Only the chunks intersecting the view are drawn
+    ChunkArea visibleChunks = GetVisibleChunks(states.transform);
+    int64_t firstChunkX = visibleChunks.firstX;
+    int64_t firstChunkY = visibleChunks.firstY;
+    int64_t lastChunkX = visibleChunks.lastX;
+    int64_t lastChunkY = visibleChunks.lastY;
+
+    std::lock_guard<std::mutex> lock(m_chunksMutex);
+
+    m_renderStatistics = {static_cast<uint32_t>(m_chunks.size()), 0, 0, 0, m_renderMode, m_geometrySize,
+        m_stream ? static_cast<uint32_t>(m_loadedChunks.size()) : static_cast<uint32_t>(m_chunks.size())};
+
+    if(m_renderMode == RenderMode::Shader)
+    {
+        // A single quad covers the visible tiles, its texture coordinates are
+        // the coordinates of the tiles
+        auto firstX = static_cast<float>(std::clamp<int64_t>(static_cast<int64_t>(std::floor(view.left / TILE_SIZE)), 0, m_width));
+        auto firstY = static_cast<float>(std::clamp<int64_t>(static_cast<int64_t>(std::floor(view.top / TILE_SIZE)), 0, m_height));
+        auto lastX = static_cast<float>(std::clamp<int64_t>(static_cast<int64_t>(std::ceil((view.left + view.width) / TILE_SIZE)), 0, m_width));
+        auto lastY = static_cast<float>(std::clamp<int64_t>(static_cast<int64_t>(std::ceil((view.top + view.height) / TILE_SIZE)), 0, m_height));
+
+        m_renderStatistics.memorySize = static_cast<uint64_t>(m_width) * m_height * 4;
+        if(firstX >= lastX || firstY >= lastY)
+        {
+            return;
+        }
+
+        sf::Vertex quad[] = {
+            sf::Vertex({firstX * TILE_SIZE, firstY * TILE_SIZE}, {firstX, firstY}),
+            sf::Vertex({lastX * TILE_SIZE, firstY * TILE_SIZE}, {lastX, firstY}),
+            sf::Vertex({firstX * TILE_SIZE, lastY * TILE_SIZE}, {firstX, lastY}),
+            sf::Vertex({lastX * TILE_SIZE, lastY * TILE_SIZE}, {lastX, lastY})
+        };
+
+        // The shader samples the textures itself
+        states.texture = nullptr;
+        states.shader = m_tilemapShader.get();
+        window.draw(quad, 4, sf::PrimitiveType::TriangleStrip, states);
 
-    // Calculate the transform matrix for the grid
+        m_renderStatistics.chunksDrawn = static_cast<uint32_t>((lastChunkX - firstChunkX + 1) * (lastChunkY - firstChunkY + 1));
+        m_renderStatistics.verticesDrawn = 4;
+        m_renderStatistics.drawCalls = 1;
+        return;
+    }
+    for(int64_t chunkY = firstChunkY; chunkY <= lastChunkY; chunkY++)
+    {
+        for(int64_t chunkX = firstChunkX; chunkX <= lastChunkX; chunkX++)
+        {
+            const Chunk& chunk = m_chunks[chunkY * m_chunkCountX + chunkX];
+            if(m_useVertexBuffers)
+            {
+                window.draw(chunk.vertexBuffer, states);
+                m_renderStatistics.verticesDrawn += chunk.vertexBuffer.getVertexCount();
+            }
+            else
+            {
+                window.draw(chunk.vertexArray, states);
+                m_renderStatistics.verticesDrawn += chunk.vertexArray.getVertexCount();
+            }
+
+            m_renderStatistics.chunksDrawn++;
+            m_renderStatistics.drawCalls++;
+        }
+    }
+}
+
+void GameGrid::BenchmarkRender(sf::RenderWindow& window, uint32_t frameCount)
+{
+    RenderMode initialMode = m_renderMode;
+    for(RenderMode renderMode : {RenderMode::Vertices, RenderMode::Shader})
+    {
+        const char* name = renderMode == RenderMode::Shader ? "shader" : "vertices";
+
+        // The next update switches the mode and sends the whole grid again
+        SetRenderMode(renderMode);
+        Update(0.f);
+        if(m_renderMode != renderMode)
+        {
+            SPDLOG_WARN("[GameGrid] The {} render mode is not available, it is not measured", name);
+            continue;
+        }
+
+        // The first frame may still upload the textures and compile the shader
+        window.clear();
+        Render(window);
+        glFinish();
+
+        // The GPU has finished drawing the frames when glFinish returns
+        sf::Clock clock;
+        for(uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            window.clear();
+            Render(window);
+        }
+        glFinish();
+        float frameTime = clock.getElapsedTime().asSeconds() / static_cast<float>(frameCount);
+
+        SPDLOG_INFO("[GameGrid] {} render mode, {} frames: {:.3f} ms per frame, {} draw calls, {} vertices, {}/{} chunks drawn",
+            name, frameCount, frameTime * 1000.0f, m_renderStatistics.drawCalls, m_renderStatistics.verticesDrawn,
+            m_renderStatistics.chunksDrawn, m_renderStatistics.chunkCount);
+    }
+
+    SetRenderMode(initialMode);
+    Update(0.f);
+}
+
+void GameGrid::BenchmarkRebuild() const
+{
+    std::vector<uint32_t> chunks = m_loadedChunks;
+    if(!m_stream)
+    {
+        chunks.resize(m_chunks.size());
+        std::iota(chunks.begin(), chunks.end(), 0);
+    }
+
+    ThreadPool& threadPool = Application::GetInstance().GetThreadPool();
+    std::vector<std::vector<sf::Vertex>> vertices(REBUILD_BATCH_SIZE);
+    auto createVertices = [this, &chunks, &vertices](size_t batchStart, size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            uint32_t chunkIndex = chunks[batchStart + i];
+            CreateChunkVertices(chunkIndex % m_chunkCountX, chunkIndex / m_chunkCountX, vertices[i]);
+        }
+    };
+
+    // The first run sizes the lists of vertices
+    for(size_t batchStart = 0; batchStart < chunks.size(); batchStart += REBUILD_BATCH_SIZE)
+    {
+        createVertices(batchStart, 0, std::min<size_t>(REBUILD_BATCH_SIZE, chunks.size() - batchStart));
+    }
+
+    sf::Clock clock;
+    for(size_t batchStart = 0; batchStart < chunks.size(); batchStart += REBUILD_BATCH_SIZE)
+    {
+        createVertices(batchStart, 0, std::min<size_t>(REBUILD_BATCH_SIZE, chunks.size() - batchStart));
+    }
+    float singleThreadTime = clock.restart().asSeconds();
+
+    size_t threadCount = 1;
+    for(size_t batchStart = 0; batchStart < chunks.size(); batchStart += REBUILD_BATCH_SIZE)
+    {
+        size_t batchSize = std::min<size_t>(REBUILD_BATCH_SIZE, chunks.size() - batchStart);
+        size_t batchThreadCount = threadPool.ParallelFor(batchSize, 1, [&createVertices, batchStart](size_t begin, size_t end)
+        {
+            createVertices(batchStart, begin, end);
+        });
+        threadCount = std::max(threadCount, batchThreadCount);
+    }
+    float threadPoolTime = clock.getElapsedTime().asSeconds();
+
+    SPDLOG_INFO("[GameGrid] Created the vertices of {} chunks: {:.2f} ms on 1 thread, {:.2f} ms on {} threads",
+        chunks.size(), singleThreadTime * 1000.0f, threadPoolTime * 1000.0f, threadCount);
+}
+
+sf::Transform GameGrid::GetCameraTransform() const
+{
     // It is dependent on the camera position and the size of the window (to center the grid)
-    states.transform.translate(
+    sf::Transform transform;
+    transform.translate(
         -m_cameraPosition * TILE_SIZE +
         sf::Vector2f(
                 Application::WINDOW_WIDTH - TILE_SIZE * static_cast<float>(m_width) * m_zoomFactor,
@@ -103,83 +1326,122 @@ void GameGrid::Render(sf::RenderWindow& window)
         ) / 2.0f
     );
 
-    states.transform.scale({m_zoomFactor, m_zoomFactor});
+    transform.scale({m_zoomFactor, m_zoomFactor});
+    return transform;
+}
+
+sf::Vector2f GameGrid::MapPixelToTile(sf::Vector2i pixel) const
+{
+    return GetCameraTransform().getInverse().transformPoint(sf::Vector2f(pixel)) / TILE_SIZE;
+}
 
-    window.draw(m_vertexArray, states);
+sf::Vector2f GameGrid::GetCameraCenter() const
+{
+    sf::Vector2f center = GetCameraTransform().getInverse().transformPoint(
+        {Application::WINDOW_WIDTH / 2.0f, Application::WINDOW_HEIGHT / 2.0f});
+    return center / TILE_SIZE;
 }
 
-sf::VertexArray GameGrid::CreateVertexArray()
+GameGrid::ChunkArea GameGrid::GetVisibleChunks(const sf::Transform& transform) const
 {
-    // A vertex array is a list of structures called vertices.
-    // Each vertex contains a position, a color and a texture coordinate
+    sf::FloatRect view = transform.getInverse().transformRect(sf::FloatRect(
+        {0, 0},
+        {static_cast<float>(Application::WINDOW_WIDTH), static_cast<float>(Application::WINDOW_HEIGHT)}
+    ));
+
+    const float chunkSize = TILE_SIZE * CHUNK_SIZE;
+    ChunkArea area{
+        static_cast<int64_t>(std::floor(view.left / chunkSize)),
+        static_cast<int64_t>(std::floor(view.top / chunkSize)),
+        static_cast<int64_t>(std::floor((view.left + view.width) / chunkSize)),
+        static_cast<int64_t>(std::floor((view.top + view.height) / chunkSize))
+    };
+
+    area.firstX = std::max<int64_t>(area.firstX, 0);
+    area.firstY = std::max<int64_t>(area.firstY, 0);
+    area.lastX = std::min<int64_t>(area.lastX, static_cast<int64_t>(m_chunkCountX) - 1);
+    area.lastY = std::min<int64_t>(area.lastY, static_cast<int64_t>(m_chunkCountY) - 1);
+    return area;
+}
+
+void GameGrid::CreateChunkVertices(uint32_t chunkX, uint32_t chunkY, std::vector<sf::Vertex>& vertices) const
+{
+    // The chunks on the edges of the grid may be smaller
+    uint32_t firstX = chunkX * CHUNK_SIZE;
+    uint32_t firstY = chunkY * CHUNK_SIZE;
+    uint32_t lastX = std::min(firstX + CHUNK_SIZE, m_width);
+    uint32_t lastY = std::min(firstY + CHUNK_SIZE, m_height);
+
+    // Each tile writes its 6 vertices at a known place, in the order of
+    // the tiles in the chunk
+    vertices.resize(static_cast<size_t>(lastX - firstX) * (lastY - firstY) * 6);
+
+    sf::Vertex* tileVertices = vertices.data();
+    for(uint32_t y = firstY; y < lastY; y++)
+    {
+        for(uint32_t x = firstX; x < lastX; x++)
+        {
+            WriteTileVertices(x, y, tileVertices);
+            tileVertices += 6;
+        }
+    }
+}
+
+void GameGrid::WriteTileVertices(uint32_t x, uint32_t y, sf::Vertex* vertices) const
+{
+    // A vertex is a structure containing a position, a color and
+    // a texture coordinate
     // The renderer uses these vertices to draw a primitive
     // (a triangle, a line, a point, etc.)
-    // Here we create a vertex array that will contain vertices
-    // defining triangles
-    sf::VertexArray vertexArray(sf::PrimitiveType::Triangles);
-
-    for(uint64_t i = 0; i < m_tiles.size(); i++)
-    {
-        std::unique_ptr<Tile>& tile = m_tiles[i];
-
-        // Calculate the position of the tile in the grid
-        uint64_t x = i % m_width;
-        uint64_t y = i / m_width;
-
-        // Calculate its position in the vertex array
-        // We do not apply any transformations here (like the camera position)
-        // because the vertex array will be transformed by the renderer
-        // in the render function using RenderStates
-        sf::Vector2f position(
-            (static_cast<float>(x) * TILE_SIZE - m_cameraPosition.x),
-            (static_cast<float>(y) * TILE_SIZE - m_cameraPosition.y)
-        );
-
-        // Calculate the texture coordinates of the tile
-        // A texture coordinates (u,v) is a pair of numbers
-        // that represent which part of the texture is used
-        // to draw the tile
-        // We do this the same way we did to calculate the
-        // position of the tile in the grid
-        float tu = static_cast<float>(tile->m_textureIndex % static_cast<uint64_t>(
-                static_cast<float>(m_tilesetTexture->getSize().x) / TILE_SIZE));
-        float tv = static_cast<float>(tile->m_textureIndex / static_cast<uint64_t>(
-                static_cast<float>(m_tilesetTexture->getSize().x) / TILE_SIZE));
-
-        sf::IntRect textureRect(
-            {static_cast<int>(tu * TILE_SIZE), static_cast<int>(tv * TILE_SIZE)},
-            {static_cast<int>(TILE_SIZE), static_cast<int>(TILE_SIZE)}
-        );
-
-        // Add the vertices to the vertex array
-        // We need to add draw 2 triangles in a square
-        // to draw the tile, so we add 6 vertices
-        vertexArray.append(sf::Vertex(
-            position,
-            {static_cast<float>(textureRect.left), static_cast<float>(textureRect.top)}
-        ));
-        vertexArray.append(sf::Vertex(
-            position + sf::Vector2f(TILE_SIZE, 0),
-            {static_cast<float>(textureRect.left + textureRect.width), static_cast<float>(textureRect.top)}
-        ));
-        vertexArray.append(sf::Vertex(
-            position + sf::Vector2f(0, TILE_SIZE),
-            {static_cast<float>(textureRect.left), static_cast<float>(textureRect.top + textureRect.height)}
-        ));
-
-        vertexArray.append(sf::Vertex(
-            position + sf::Vector2f(TILE_SIZE, 0),
-            {static_cast<float>(textureRect.left + textureRect.width), static_cast<float>(textureRect.top)}
-        ));
-        vertexArray.append(sf::Vertex(
-            position + sf::Vector2f(TILE_SIZE, TILE_SIZE),
-            {static_cast<float>(textureRect.left + textureRect.width), static_cast<float>(textureRect.top + textureRect.height)}
-        ));
-        vertexArray.append(sf::Vertex(
-            position + sf::Vector2f(0, TILE_SIZE),
-            {static_cast<float>(textureRect.left), static_cast<float>(textureRect.top + textureRect.height)}
-        ));
-    }
-
-    return vertexArray;
+    // Here we create vertices defining triangles
+
+    uint16_t textureIndex = GetTextureIndex(x, y);
+
+    // Calculate its position in the chunk geometry
+    // We do not apply any transformations here (like the camera position)
+    // because the geometry will be transformed by the renderer
+    // in the render function using RenderStates
+    sf::Vector2f position(
+        static_cast<float>(x) * TILE_SIZE,
+        static_cast<float>(y) * TILE_SIZE
+    );
+
+    // Calculate the texture coordinates of the tile
+    // A texture coordinates (u,v) is a pair of numbers
+    // that represent which part of the texture is used
+    // to draw the tile
+    // The tileset knows where the tile is in its texture, as
+    // the tiles are spaced out by gutters
+    sf::Vector2f textureOrigin = m_tileset->GetTileOrigin(textureIndex);
+
+    auto tileTextureSize = static_cast<float>(Tileset::TILE_SIZE);
+    sf::FloatRect textureRect(textureOrigin, {tileTextureSize, tileTextureSize});
+
+    // We need to add draw 2 triangles in a square
+    // to draw the tile, so we write 6 vertices
+    vertices[0] = sf::Vertex(
+        position,
+        {textureRect.left, textureRect.top}
+    );
+    vertices[1] = sf::Vertex(
+        position + sf::Vector2f(TILE_SIZE, 0),
+        {textureRect.left + textureRect.width, textureRect.top}
+    );
+    vertices[2] = sf::Vertex(
+        position + sf::Vector2f(0, TILE_SIZE),
+        {textureRect.left, textureRect.top + textureRect.height}
+    );
+
+    vertices[3] = sf::Vertex(
+        position + sf::Vector2f(TILE_SIZE, 0),
+        {textureRect.left + textureRect.width, textureRect.top}
+    );
+    vertices[4] = sf::Vertex(
+        position + sf::Vector2f(TILE_SIZE, TILE_SIZE),
+        {textureRect.left + textureRect.width, textureRect.top + textureRect.height}
+    );
+    vertices[5] = sf::Vertex(
+        position + sf::Vector2f(0, TILE_SIZE),
+        {textureRect.left, textureRect.top + textureRect.height}
+    );
 }
\ No newline at end of file
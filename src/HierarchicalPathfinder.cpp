@@ -0,0 +1,704 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <HierarchicalPathfinder.h>
+#include <GameGrid.h>
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+    // The search data of a node, only valid if its generation is the generation
+    // of the current search (see Pathfinder)
+    struct SearchNode
+    {
+        uint32_t generation;
+        uint32_t cost; // cost from the start
+        uint32_t parent; // UINT32_MAX for the start
+        bool closed;
+    };
+
+    // The state of the searches, kept by each thread between the queries
+    struct SearchState
+    {
+        std::vector<SearchNode> nodes;
+        uint32_t generation = 0;
+
+        // Heaps of (cost or estimate, node or tile), smallest first
+        std::vector<std::pair<uint32_t, uint32_t>> openNodes;
+        std::vector<std::pair<uint32_t, uint32_t>> openTiles;
+
+        // The costs from the start and to the goal inside of their clusters
+        std::vector<uint32_t> startCosts;
+        std::vector<uint32_t> goalCosts;
+
+        std::vector<uint32_t> pathNodes;
+        std::vector<sf::Vector2u> segment;
+
+        void Begin(size_t nodeCount)
+        {
+            if(nodes.size() < nodeCount)
+            {
+                nodes.assign(nodeCount, SearchNode{});
+                generation = 0;
+            }
+
+            if(++generation == 0)
+            {
+                std::fill(nodes.begin(), nodes.end(), SearchNode{});
+                generation = 1;
+            }
+
+            openNodes.clear();
+        }
+    };
+
+    thread_local SearchState s_searchState;
+
+    constexpr uint32_t UNREACHABLE = UINT32_MAX;
+
+    inline uint32_t GetDistance(uint32_t x1, uint32_t y1, uint32_t x2, uint32_t y2)
+    {
+        return (x1 > x2 ? x1 - x2 : x2 - x1) + (y1 > y2 ? y1 - y2 : y2 - y1);
+    }
+}
+
+HierarchicalPathfinder::HierarchicalPathfinder(const GameGrid& grid)
+    : m_grid(grid), m_costs(grid.GetMovementCosts()), m_pathfinder(grid),
+      m_width(grid.GetWidth()), m_height(grid.GetHeight()),
+      m_clusterCountX(grid.GetChunkCountX()), m_clusterCountY(grid.GetChunkCountY())
+{
+    static_assert(CLUSTER_SIZE == GameGrid::CHUNK_SIZE, "The clusters must be the chunks of the grid");
+
+    m_clusters.resize(static_cast<size_t>(m_clusterCountX) * m_clusterCountY);
+    Refresh();
+}
+
+void HierarchicalPathfinder::Refresh()
+{
+    // The clusters whose tiles were replaced, or which were never computed. The
+    // borders of a cluster depend on its neighbors, so it waits until they are
+    // all loaded (a streamed chunk keeps its version when it is reloaded)
+    std::vector<bool> changedClusters(m_clusters.size(), false);
+    bool changed = false;
+    for(uint32_t i = 0; i < m_clusters.size(); i++)
+    {
+        uint32_t version = m_grid.GetChunkVersion(i);
+        if(version != m_clusters[i].version && IsClusterLoaded(i))
+        {
+            m_clusters[i].version = version;
+            changedClusters[i] = true;
+            changed = true;
+        }
+    }
+
+    if(!changed)
+    {
+        return;
+    }
+
+    // The entrances of the 4 borders of a changed cluster may have moved, and
+    // then the nodes of the neighbor on the other side too
+    std::vector<bool> updatedClusters = changedClusters;
+    for(uint32_t i = 0; i < m_clusters.size(); i++)
+    {
+        if(!changedClusters[i])
+        {
+            continue;
+        }
+
+        uint32_t clusterX = i % m_clusterCountX;
+        uint32_t clusterY = i / m_clusterCountX;
+        if(clusterX + 1 < m_clusterCountX && UpdateEntrances(i, true))
+        {
+            updatedClusters[i + 1] = true;
+        }
+        if(clusterY + 1 < m_clusterCountY && UpdateEntrances(i, false))
+        {
+            updatedClusters[i + m_clusterCountX] = true;
+        }
+        if(clusterX > 0 && !changedClusters[i - 1] && UpdateEntrances(i - 1, true))
+        {
+            updatedClusters[i - 1] = true;
+        }
+        if(clusterY > 0 && !changedClusters[i - m_clusterCountX] && UpdateEntrances(i - m_clusterCountX, false))
+        {
+            updatedClusters[i - m_clusterCountX] = true;
+        }
+
+        m_grid.GetPassagePoints(i, m_clusters[i].passagePoints);
+    }
+
+    // The costs inside of the other clusters are kept, and the edges are read
+    // from the clusters by the queries, so nothing else is computed again
+    uint32_t updatedCount = 0;
+    bool nodeCountChanged = false;
+    for(uint32_t i = 0; i < m_clusters.size(); i++)
+    {
+        if(updatedClusters[i])
+        {
+            size_t nodeCount = m_clusters[i].nodes.size();
+            UpdateCluster(i);
+            nodeCountChanged |= m_clusters[i].nodes.size() != nodeCount;
+            updatedCount++;
+        }
+    }
+
+    if(nodeCountChanged)
+    {
+        NumberNodes();
+    }
+
+    SPDLOG_DEBUG("[HierarchicalPathfinder] {} of {} clusters updated, {} nodes",
+        updatedCount, m_clusters.size(), m_nodeClusters.size());
+}
+
+bool HierarchicalPathfinder::IsClusterLoaded(uint32_t clusterIndex) const
+{
+    uint32_t firstX = (clusterIndex % m_clusterCountX) * CLUSTER_SIZE;
+    uint32_t firstY = (clusterIndex / m_clusterCountX) * CLUSTER_SIZE;
+    return m_grid.IsTileLoaded(firstX, firstY)
+        && (firstX == 0 || m_grid.IsTileLoaded(firstX - 1, firstY))
+        && (firstY == 0 || m_grid.IsTileLoaded(firstX, firstY - 1))
+        && (firstX + CLUSTER_SIZE >= m_width || m_grid.IsTileLoaded(firstX + CLUSTER_SIZE, firstY))
+        && (firstY + CLUSTER_SIZE >= m_height || m_grid.IsTileLoaded(firstX, firstY + CLUSTER_SIZE));
+}
+
+bool HierarchicalPathfinder::UpdateEntrances(uint32_t clusterIndex, bool right)
+{
+    uint32_t firstX = (clusterIndex % m_clusterCountX) * CLUSTER_SIZE;
+    uint32_t firstY = (clusterIndex / m_clusterCountX) * CLUSTER_SIZE;
+
+    // A cluster with a neighbor on a side is full on this side
+    uint32_t length = right ? std::min(CLUSTER_SIZE, m_height - firstY) : std::min(CLUSTER_SIZE, m_width - firstX);
+    uint32_t offset = right ? 1 : m_width;
+
+    // An entrance is a run of tiles that can be walked on on both sides of the
+    // border, the nodes are in its middle
+    std::vector<uint32_t> entrances;
+    uint32_t runStart = 0;
+    bool inRun = false;
+    for(uint32_t i = 0; i <= length; i++)
+    {
+        bool open = false;
+        if(i < length)
+        {
+            uint32_t x = right ? firstX + CLUSTER_SIZE - 1 : firstX + i;
+            uint32_t y = right ? firstY + i : firstY + CLUSTER_SIZE - 1;
+            size_t index = static_cast<size_t>(y) * m_width + x;
+            open = m_costs[index] != 0 && m_costs[index + offset] != 0;
+        }
+
+        if(open && !inRun)
+        {
+            runStart = i;
+            inRun = true;
+        }
+        else if(!open && inRun)
+        {
+            entrances.push_back((right ? firstY : firstX) + (runStart + i - 1) / 2);
+            inRun = false;
+        }
+    }
+
+    std::vector<uint32_t>& currentEntrances = right ? m_clusters[clusterIndex].rightEntrances
+                                                    : m_clusters[clusterIndex].bottomEntrances;
+    if(entrances == currentEntrances)
+    {
+        return false;
+    }
+
+    currentEntrances = std::move(entrances);
+    return true;
+}
+
+void HierarchicalPathfinder::UpdateCluster(uint32_t clusterIndex)
+{
+    Cluster& cluster = m_clusters[clusterIndex];
+    uint32_t clusterX = clusterIndex % m_clusterCountX;
+    uint32_t clusterY = clusterIndex / m_clusterCountX;
+    uint32_t firstX = clusterX * CLUSTER_SIZE;
+    uint32_t firstY = clusterY * CLUSTER_SIZE;
+
+    // The nodes on the borders owned by the cluster, then on the borders owned
+    // by its left and top neighbors
+    cluster.nodes.clear();
+    for(uint32_t y : cluster.rightEntrances)
+    {
+        cluster.nodes.push_back(y * m_width + firstX + CLUSTER_SIZE - 1);
+    }
+    for(uint32_t x : cluster.bottomEntrances)
+    {
+        cluster.nodes.push_back((firstY + CLUSTER_SIZE - 1) * m_width + x);
+    }
+    if(clusterX > 0)
+    {
+        for(uint32_t y : m_clusters[clusterIndex - 1].rightEntrances)
+        {
+            cluster.nodes.push_back(y * m_width + firstX);
+        }
+    }
+    if(clusterY > 0)
+    {
+        for(uint32_t x : m_clusters[clusterIndex - m_clusterCountX].bottomEntrances)
+        {
+            cluster.nodes.push_back(firstY * m_width + x);
+        }
+    }
+
+    // A corner tile can be the node of two borders
+    std::sort(cluster.nodes.begin(), cluster.nodes.end());
+    cluster.nodes.erase(std::unique(cluster.nodes.begin(), cluster.nodes.end()), cluster.nodes.end());
+
+    size_t nodeCount = cluster.nodes.size();
+    cluster.costs.assign(nodeCount * nodeCount, UNREACHABLE);
+
+    std::vector<uint32_t> tileCosts;
+    for(size_t from = 0; from < nodeCount; from++)
+    {
+        SearchCluster(clusterIndex, cluster.nodes[from], false, tileCosts);
+        for(size_t to = 0; to < nodeCount; to++)
+        {
+            uint32_t x = cluster.nodes[to] % m_width;
+            uint32_t y = cluster.nodes[to] / m_width;
+            cluster.costs[from * nodeCount + to] = tileCosts[(y % CLUSTER_SIZE) * CLUSTER_SIZE + x % CLUSTER_SIZE];
+        }
+    }
+}
+
+void HierarchicalPathfinder::NumberNodes()
+{
+    m_nodeClusters.clear();
+    for(uint32_t i = 0; i < m_clusters.size(); i++)
+    {
+        m_clusters[i].firstNode = static_cast<uint32_t>(m_nodeClusters.size());
+        m_nodeClusters.insert(m_nodeClusters.end(), m_clusters[i].nodes.size(), i);
+    }
+}
+
+uint32_t HierarchicalPathfinder::FindNode(uint32_t clusterIndex, uint32_t tile) const
+{
+    const Cluster& cluster = m_clusters[clusterIndex];
+    auto iterator = std::lower_bound(cluster.nodes.begin(), cluster.nodes.end(), tile);
+    if(iterator == cluster.nodes.end() || *iterator != tile)
+    {
+        return UNREACHABLE;
+    }
+    return cluster.firstNode + static_cast<uint32_t>(iterator - cluster.nodes.begin());
+}
+
+void HierarchicalPathfinder::SearchCluster(uint32_t clusterIndex, uint32_t source, bool reverse,
+                                           std::vector<uint32_t>& costs) const
+{
+    uint32_t firstX = (clusterIndex % m_clusterCountX) * CLUSTER_SIZE;
+    uint32_t firstY = (clusterIndex / m_clusterCountX) * CLUSTER_SIZE;
+    uint32_t lastX = std::min(firstX + CLUSTER_SIZE, m_width) - 1;
+    uint32_t lastY = std::min(firstY + CLUSTER_SIZE, m_height) - 1;
+
+    auto getCell = [](uint32_t x, uint32_t y) { return (y % CLUSTER_SIZE) * CLUSTER_SIZE + x % CLUSTER_SIZE; };
+
+    costs.assign(CLUSTER_SIZE * CLUSTER_SIZE, UNREACHABLE);
+    costs[getCell(source % m_width, source / m_width)] = 0;
+
+    // Dijkstra, bounded by the cluster
+    std::vector<std::pair<uint32_t, uint32_t>>& openTiles = s_searchState.openTiles;
+    openTiles.clear();
+    openTiles.emplace_back(0, source);
+
+    while(!openTiles.empty())
+    {
+        std::pop_heap(openTiles.begin(), openTiles.end(), std::greater<>());
+        auto [cost, index] = openTiles.back();
+        openTiles.pop_back();
+
+        uint32_t x = index % m_width;
+        uint32_t y = index / m_width;
+        if(cost > costs[getCell(x, y)])
+        {
+            continue;
+        }
+
+        auto visit = [&](uint32_t neighborX, uint32_t neighborY, uint32_t neighbor)
+        {
+            if(m_costs[neighbor] == 0)
+            {
+                return;
+            }
+
+            // Going backwards, the step from the neighbor enters this tile
+            uint32_t neighborCost = cost + (reverse ? m_costs[index] : m_costs[neighbor]);
+            uint32_t& currentCost = costs[getCell(neighborX, neighborY)];
+            if(neighborCost < currentCost)
+            {
+                currentCost = neighborCost;
+                openTiles.emplace_back(neighborCost, neighbor);
+                std::push_heap(openTiles.begin(), openTiles.end(), std::greater<>());
+            }
+        };
+
+        if(x > firstX) visit(x - 1, y, index - 1);
+        if(x < lastX) visit(x + 1, y, index + 1);
+        if(y > firstY) visit(x, y - 1, index - m_width);
+        if(y < lastY) visit(x, y + 1, index + m_width);
+    }
+}
+
+bool HierarchicalPathfinder::SearchGraph(sf::Vector2u start, sf::Vector2u goal, std::vector<uint32_t>& nodes,
+                                         uint32_t& cost) const
+{
+    nodes.clear();
+
+    SearchState& state = s_searchState;
+    uint32_t startCluster = GetClusterIndex(start.x, start.y);
+    uint32_t goalCluster = GetClusterIndex(goal.x, goal.y);
+    SearchCluster(startCluster, start.y * m_width + start.x, false, state.startCosts);
+    SearchCluster(goalCluster, goal.y * m_width + goal.x, true, state.goalCosts);
+
+    // The goal is an extra node after the nodes of the graph, linked to the nodes
+    // of its cluster
+    auto goalNode = static_cast<uint32_t>(m_nodeClusters.size());
+    state.Begin(m_nodeClusters.size() + 1);
+
+    auto getTile = [this](uint32_t node)
+    {
+        const Cluster& cluster = m_clusters[m_nodeClusters[node]];
+        return cluster.nodes[node - cluster.firstNode];
+    };
+
+    auto getCell = [this](uint32_t tile)
+    {
+        return ((tile / m_width) % CLUSTER_SIZE) * CLUSTER_SIZE + (tile % m_width) % CLUSTER_SIZE;
+    };
+
+    auto open = [&](uint32_t node, uint32_t nodeCost, uint32_t parent)
+    {
+        SearchNode& searchNode = state.nodes[node];
+        if(searchNode.generation == state.generation && (searchNode.closed || nodeCost >= searchNode.cost))
+        {
+            return;
+        }
+        searchNode = {state.generation, nodeCost, parent, false};
+
+        uint32_t heuristic = 0;
+        if(node != goalNode)
+        {
+            uint32_t tile = getTile(node);
+            heuristic = GetDistance(tile % m_width, tile / m_width, goal.x, goal.y) * GameGrid::MOVEMENT_COST_FAST;
+        }
+        state.openNodes.emplace_back(nodeCost + heuristic, node);
+        std::push_heap(state.openNodes.begin(), state.openNodes.end(), std::greater<>());
+    };
+
+    const Cluster& firstCluster = m_clusters[startCluster];
+    for(uint32_t i = 0; i < firstCluster.nodes.size(); i++)
+    {
+        uint32_t startCost = state.startCosts[getCell(firstCluster.nodes[i])];
+        if(startCost != UNREACHABLE)
+        {
+            open(firstCluster.firstNode + i, startCost, UNREACHABLE);
+        }
+    }
+
+    while(!state.openNodes.empty())
+    {
+        std::pop_heap(state.openNodes.begin(), state.openNodes.end(), std::greater<>());
+        uint32_t node = state.openNodes.back().second;
+        state.openNodes.pop_back();
+
+        SearchNode& searchNode = state.nodes[node];
+        if(searchNode.closed)
+        {
+            continue;
+        }
+        searchNode.closed = true;
+
+        if(node == goalNode)
+        {
+            cost = searchNode.cost;
+            for(uint32_t pathNode = searchNode.parent; pathNode != UNREACHABLE; pathNode = state.nodes[pathNode].parent)
+            {
+                nodes.push_back(getTile(pathNode));
+            }
+            std::reverse(nodes.begin(), nodes.end());
+            return true;
+        }
+
+        // The edges inside of the cluster of the node
+        uint32_t nodeCost = searchNode.cost;
+        uint32_t clusterIndex = m_nodeClusters[node];
+        const Cluster& cluster = m_clusters[clusterIndex];
+        uint32_t localNode = node - cluster.firstNode;
+        size_t nodeCount = cluster.nodes.size();
+        for(size_t to = 0; to < nodeCount; to++)
+        {
+            uint32_t edgeCost = cluster.costs[localNode * nodeCount + to];
+            if(to != localNode && edgeCost != UNREACHABLE)
+            {
+                open(cluster.firstNode + static_cast<uint32_t>(to), nodeCost + edgeCost, node);
+            }
+        }
+
+        // The edges crossing the borders where the node is an entrance. Entering
+        // a tile costs its movement cost, so crossing a border in both directions
+        // does not always cost the same, and the tiles of an unloaded chunk have
+        // no cost, so it cannot be entered
+        uint32_t tile = cluster.nodes[localNode];
+        uint32_t x = tile % m_width;
+        uint32_t y = tile / m_width;
+        auto cross = [&](uint32_t neighborIndex, uint32_t neighborTile)
+        {
+            uint32_t neighborNode = FindNode(neighborIndex, neighborTile);
+            if(neighborNode != UNREACHABLE && m_costs[neighborTile] != 0)
+            {
+                open(neighborNode, nodeCost + m_costs[neighborTile], node);
+            }
+        };
+
+        if(x % CLUSTER_SIZE == CLUSTER_SIZE - 1 && x + 1 < m_width
+           && std::binary_search(cluster.rightEntrances.begin(), cluster.rightEntrances.end(), y))
+        {
+            cross(clusterIndex + 1, tile + 1);
+        }
+        if(x % CLUSTER_SIZE == 0 && x > 0)
+        {
+            const std::vector<uint32_t>& entrances = m_clusters[clusterIndex - 1].rightEntrances;
+            if(std::binary_search(entrances.begin(), entrances.end(), y))
+            {
+                cross(clusterIndex - 1, tile - 1);
+            }
+        }
+        if(y % CLUSTER_SIZE == CLUSTER_SIZE - 1 && y + 1 < m_height
+           && std::binary_search(cluster.bottomEntrances.begin(), cluster.bottomEntrances.end(), x))
+        {
+            cross(clusterIndex + m_clusterCountX, tile + m_width);
+        }
+        if(y % CLUSTER_SIZE == 0 && y > 0)
+        {
+            const std::vector<uint32_t>& entrances = m_clusters[clusterIndex - m_clusterCountX].bottomEntrances;
+            if(std::binary_search(entrances.begin(), entrances.end(), x))
+            {
+                cross(clusterIndex - m_clusterCountX, tile - m_width);
+            }
+        }
+
+        if(clusterIndex == goalCluster)
+        {
+            uint32_t goalCost = state.goalCosts[getCell(tile)];
+            if(goalCost != UNREACHABLE)
+            {
+                open(goalNode, nodeCost + goalCost, node);
+            }
+        }
+    }
+
+    return false;
+}
+
+bool HierarchicalPathfinder::IsShortQuery(sf::Vector2u start, sf::Vector2u goal) const
+{
+    return GetClusterIndex(start.x, start.y) == GetClusterIndex(goal.x, goal.y)
+        || GetDistance(start.x, start.y, goal.x, goal.y) <= CLUSTER_SIZE;
+}
+
+bool HierarchicalPathfinder::FindPath(sf::Vector2u start, sf::Vector2u goal, std::vector<sf::Vector2u>& path) const
+{
+    path.clear();
+    if(start.x >= m_width || start.y >= m_height || goal.x >= m_width || goal.y >= m_height
+       || m_costs[goal.y * m_width + goal.x] == 0)
+    {
+        return false;
+    }
+
+    if(IsShortQuery(start, goal))
+    {
+        return m_pathfinder.FindPath(start, goal, path);
+    }
+
+    SearchState& state = s_searchState;
+    uint32_t cost;
+    if(!SearchGraph(start, goal, state.pathNodes, cost))
+    {
+        return false;
+    }
+
+    // Refine each step of the abstract path, which are short searches
+    path.push_back(start);
+    sf::Vector2u from = start;
+    for(size_t i = 0; i <= state.pathNodes.size(); i++)
+    {
+        sf::Vector2u to = goal;
+        if(i < state.pathNodes.size())
+        {
+            to = {state.pathNodes[i] % m_width, state.pathNodes[i] / m_width};
+        }
+
+        if(to == from)
+        {
+            continue;
+        }
+
+        if(!m_pathfinder.FindPath(from, to, state.segment))
+        {
+            path.clear();
+            return false;
+        }
+        path.insert(path.end(), state.segment.begin() + 1, state.segment.end());
+        from = to;
+    }
+
+    return true;
+}
+
+bool HierarchicalPathfinder::FindCost(sf::Vector2u start, sf::Vector2u goal, uint32_t& cost) const
+{
+    if(start.x >= m_width || start.y >= m_height || goal.x >= m_width || goal.y >= m_height
+       || m_costs[goal.y * m_width + goal.x] == 0)
+    {
+        return false;
+    }
+
+    SearchState& state = s_searchState;
+    if(IsShortQuery(start, goal))
+    {
+        if(!m_pathfinder.FindPath(start, goal, state.segment))
+        {
+            return false;
+        }
+
+        cost = 0;
+        for(size_t i = 1; i < state.segment.size(); i++)
+        {
+            cost += m_costs[state.segment[i].y * m_width + state.segment[i].x];
+        }
+        return true;
+    }
+
+    return SearchGraph(start, goal, state.pathNodes, cost);
+}
+
+bool HierarchicalPathfinder::FindRoute(const std::unordered_map<std::string, const HierarchicalPathfinder*>& maps,
+                                       const std::string& startTilemap, sf::Vector2u start,
+                                       const std::string& goalTilemap, sf::Vector2u goal,
+                                       std::vector<RouteLeg>& route)
+{
+    route.clear();
+    if(maps.count(startTilemap) == 0 || maps.count(goalTilemap) == 0)
+    {
+        return false;
+    }
+
+    // A passage point leading to a known map
+    struct Link
+    {
+        const std::string* tilemap;
+        sf::Vector2u position;
+        const std::string* destinationTilemap;
+        sf::Vector2u destination;
+    };
+
+    std::vector<Link> links;
+    for(const auto& [tilemap, pathfinder] : maps)
+    {
+        for(const Cluster& cluster : pathfinder->m_clusters)
+        {
+            for(const auto& [position, passagePoint] : cluster.passagePoints)
+            {
+                auto destination = passagePoint.tilemap.empty() ? maps.find(tilemap) : maps.find(passagePoint.tilemap);
+                if(destination != maps.end())
+                {
+                    links.push_back({&tilemap, position, &destination->first, {passagePoint.x, passagePoint.y}});
+                }
+            }
+        }
+    }
+
+    // Dijkstra over the passage points, the goal being the last node: there are
+    // few passage points, and each step is a search in a map
+    auto goalNode = static_cast<uint32_t>(links.size());
+    std::vector<uint32_t> costs(links.size() + 1, UNREACHABLE);
+    std::vector<uint32_t> parents(links.size() + 1, UNREACHABLE);
+    std::vector<bool> visited(links.size() + 1, false);
+
+    auto openFrom = [&](const std::string& tilemap, sf::Vector2u position, uint32_t positionCost, uint32_t parent)
+    {
+        const HierarchicalPathfinder& pathfinder = *maps.at(tilemap);
+        uint32_t cost;
+        for(uint32_t i = 0; i < links.size(); i++)
+        {
+            if(!visited[i] && *links[i].tilemap == tilemap && pathfinder.FindCost(position, links[i].position, cost)
+               && positionCost + cost < costs[i])
+            {
+                costs[i] = positionCost + cost;
+                parents[i] = parent;
+            }
+        }
+        if(tilemap == goalTilemap && pathfinder.FindCost(position, goal, cost) && positionCost + cost < costs[goalNode])
+        {
+            costs[goalNode] = positionCost + cost;
+            parents[goalNode] = parent;
+        }
+    };
+
+    openFrom(startTilemap, start, 0, UNREACHABLE);
+    while(true)
+    {
+        uint32_t node = UNREACHABLE;
+        for(uint32_t i = 0; i <= goalNode; i++)
+        {
+            if(!visited[i] && costs[i] != UNREACHABLE && (node == UNREACHABLE || costs[i] < costs[node]))
+            {
+                node = i;
+            }
+        }
+
+        if(node == UNREACHABLE)
+        {
+            return false;
+        }
+        if(node == goalNode)
+        {
+            break;
+        }
+
+        // Walking on the passage point moves to its destination
+        visited[node] = true;
+        openFrom(*links[node].destinationTilemap, links[node].destination, costs[node], node);
+    }
+
+    std::vector<uint32_t> usedLinks;
+    for(uint32_t link = parents[goalNode]; link != UNREACHABLE; link = parents[link])
+    {
+        usedLinks.push_back(link);
+    }
+    std::reverse(usedLinks.begin(), usedLinks.end());
+
+    // Only the legs of the route are refined
+    const std::string* tilemap = &startTilemap;
+    sf::Vector2u from = start;
+    for(size_t i = 0; i <= usedLinks.size(); i++)
+    {
+        const std::string* legTilemap = tilemap;
+        sf::Vector2u to = goal;
+        if(i < usedLinks.size())
+        {
+            const Link& link = links[usedLinks[i]];
+            to = link.position;
+            tilemap = link.destinationTilemap;
+        }
+
+        RouteLeg& leg = route.emplace_back();
+        leg.tilemap = *legTilemap;
+        if(!maps.at(*legTilemap)->FindPath(from, to, leg.path))
+        {
+            route.clear();
+            return false;
+        }
+
+        if(i < usedLinks.size())
+        {
+            from = links[usedLinks[i]].destination;
+        }
+    }
+
+    return true;
+}
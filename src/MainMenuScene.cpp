@@ -4,6 +4,9 @@
 #include <MainMenuScene.h>
 #include <Application.h>
 #include <GameGrid.h>
+#include <FlowField.h>
+#include <Pathfinder.h>
+#include <Tilemap.h>
 
 MainMenuScene::MainMenuScene() : Scene("MainMenuScene")
 {
@@ -35,10 +38,10 @@ void MainMenuScene::Init()
         {
             SPDLOG_INFO("Initializing MainMenuScene...");
 
-            m_mainMenuTexture = Application::GetInstance().GetTextureRegistry().GetResource("main_menu.png");
-            m_mainMenuSprite.setTexture(m_mainMenuTexture);
+            m_mainMenuRegion = Application::GetInstance().GetTextureAtlas().GetRegion("main_menu.png");
+            m_mainMenuSprite.setTexture(*m_mainMenuRegion.texture);
 
-            sf::Vector2u mainMenuSize = static_cast<const sf::Texture &>(m_mainMenuTexture).getSize();
+            sf::Vector2u mainMenuSize = sf::Vector2u(m_mainMenuRegion.rect.getSize());
             sf::Vector2u windowSize = sf::Vector2u(Application::WINDOW_WIDTH, Application::WINDOW_HEIGHT);
             sf::Vector2f scale = sf::Vector2f(
                     static_cast<float>(windowSize.x) / static_cast<float>(mainMenuSize.x),
@@ -48,12 +51,14 @@ void MainMenuScene::Init()
             m_mainMenuSprite.setScale({std::max(scale.x, scale.y), std::max(scale.x, scale.y)});
             m_mainMenuSprite.setOrigin({mainMenuSize.x / 2.0f, mainMenuSize.y / 2.0f});
             m_mainMenuSprite.setPosition({windowSize.x / 2.0f, windowSize.y / 2.0f});
-            m_mainMenuSprite.setTextureRect(sf::IntRect(
-                {0, 0},
-                {static_cast<int>(mainMenuSize.x), static_cast<int>(mainMenuSize.y)}
-            ));
+            m_mainMenuSprite.setTextureRect(m_mainMenuRegion.rect);
 
-            m_testGameGrid = GameGrid::ReadFromFile("assets/tilemaps/tilemap.htf");
+            m_testGameGrid = GameGrid::ReadFromFile("tilemap.htf");
+            m_testGameGrid->SetAutosaveInterval(AUTOSAVE_INTERVAL);
+#ifdef DEBUG
+            m_pathfinder = std::make_unique<HierarchicalPathfinder>(*m_testGameGrid);
+            m_flowFields = std::make_unique<FlowFieldCache>(*m_testGameGrid, Application::GetInstance().GetThreadPool());
+#endif
 
             for (int i = 0; i < 100; i++)
             {
@@ -93,6 +98,48 @@ void MainMenuScene::HandleEvent(const sf::Event &event)
         {
             m_cameraMovement.y += 2;
         }
+        else if (event.key.code == sf::Keyboard::F5 && m_loaded)
+        {
+            // Written by the thread pool, the game keeps running
+            if (!m_testGameGrid->SaveAsync())
+            {
+                SPDLOG_INFO("The grid cannot be saved now, or the previous save is still being written");
+            }
+        }
+#ifdef DEBUG
+        else if (event.key.code == sf::Keyboard::B)
+        {
+            // Runs in the background, the pathfinder uses the other threads as well
+            Application::GetInstance().GetThreadPool().Enqueue([]()
+            {
+                Pathfinder::Benchmark(Application::GetInstance().GetThreadPool(), 512, 8192);
+            });
+        }
+        else if (event.key.code == sf::Keyboard::L)
+        {
+            // Runs in the background, the chunks are parsed by the other threads as well
+            Application::GetInstance().GetThreadPool().Enqueue([]()
+            {
+                Tilemap::Benchmark(Application::GetInstance().GetThreadPool());
+            });
+        }
+        else if (event.key.code == sf::Keyboard::M && m_loaded)
+        {
+            // Compare the cost of the render modes on the same view
+            m_testGameGrid->SetRenderMode(m_testGameGrid->GetRenderMode() == GameGrid::RenderMode::Vertices
+                ? GameGrid::RenderMode::Shader
+                : GameGrid::RenderMode::Vertices);
+        }
+        else if (event.key.code == sf::Keyboard::R && m_loaded)
+        {
+            m_renderBenchmarkRequested = true;
+        }
+        else if (event.key.code == sf::Keyboard::V && m_loaded)
+        {
+            // The vertices are only created, the grid is not modified
+            m_testGameGrid->BenchmarkRebuild();
+        }
+#endif
     }
     else if (event.type == sf::Event::KeyReleased)
     {
@@ -113,6 +160,36 @@ void MainMenuScene::HandleEvent(const sf::Event &event)
             m_cameraMovement.y -= 2;
         }
     }
+#ifdef DEBUG
+    else if (event.type == sf::Event::MouseButtonPressed && m_loaded)
+    {
+        sf::Vector2f tile = m_testGameGrid->MapPixelToTile({event.mouseButton.x, event.mouseButton.y});
+        if (tile.x >= 0 && tile.y >= 0
+            && tile.x < static_cast<float>(m_testGameGrid->GetWidth())
+            && tile.y < static_cast<float>(m_testGameGrid->GetHeight()))
+        {
+            sf::Vector2u goal(tile);
+            sf::Clock clock;
+            if (event.mouseButton.button == sf::Mouse::Left)
+            {
+                // Find the path from the previous clicked tile
+                bool found = m_pathfinder->FindPath(m_pathStart, goal, m_path);
+                SPDLOG_INFO("Path from ({}, {}) to ({}, {}): {} tiles, {} us", m_pathStart.x, m_pathStart.y, goal.x, goal.y,
+                    found ? m_path.size() : 0, clock.getElapsedTime().asMicroseconds());
+                m_pathStart = goal;
+            }
+            else if (event.mouseButton.button == sf::Mouse::Right)
+            {
+                // The crowds walking to the same tile share its field, it is only computed by the first request
+                std::shared_ptr<const FlowField> field = m_flowFields->GetFlowField(goal);
+                uint32_t cost = field->Contains(m_pathStart.x, m_pathStart.y) ? field->GetCost(m_pathStart.x, m_pathStart.y) : FlowField::UNREACHABLE;
+                SPDLOG_INFO("Flow field to ({}, {}): cost {} from ({}, {}), {} fields cached, {} us", goal.x, goal.y,
+                    cost == FlowField::UNREACHABLE ? -1 : static_cast<int64_t>(cost), m_pathStart.x, m_pathStart.y,
+                    m_flowFields->GetFieldCount(), clock.getElapsedTime().asMicroseconds());
+            }
+        }
+    }
+#endif
     else if (event.type == sf::Event::MouseWheelScrolled)
     {
         m_zoomDelta = event.mouseWheelScroll.delta * 20;
@@ -139,6 +216,32 @@ void MainMenuScene::Update(float deltaTime)
         m_zoomDelta = 0;
 
         m_testGameGrid->Update(deltaTime);
+
+#ifdef DEBUG
+        // The graph and the fields only change with the tiles and the loaded chunks
+        if (m_testGameGrid->GetVersion() != m_pathfinderVersion)
+        {
+            m_pathfinder->Refresh();
+            m_flowFields->Refresh();
+            m_pathfinderVersion = m_testGameGrid->GetVersion();
+        }
+
+        m_statisticsTimer += deltaTime;
+        m_statisticsFrameCount++;
+        if(m_statisticsTimer >= 1.0f)
+        {
+            GameGrid::RenderStatistics statistics = m_testGameGrid->GetRenderStatistics();
+            SPDLOG_DEBUG("Grid ({}): {}/{} chunks drawn, {} chunks loaded, {} vertices, {} draw calls, {} KiB on the GPU, {} active tiles, {:.3f} ms per frame",
+                statistics.renderMode == GameGrid::RenderMode::Shader ? "shader" : "vertices",
+                statistics.chunksDrawn, statistics.chunkCount, statistics.chunksLoaded, statistics.verticesDrawn,
+                statistics.drawCalls,
+                statistics.memorySize / 1024, m_testGameGrid->GetActiveTileCount(),
+                m_statisticsTimer * 1000.0f / static_cast<float>(m_statisticsFrameCount));
+
+            m_statisticsTimer = 0.0f;
+            m_statisticsFrameCount = 0;
+        }
+#endif
     }
 }
 
@@ -147,10 +250,36 @@ void MainMenuScene::Render(sf::RenderWindow &window) {
         // Loading Screen
         window.draw(m_loadingScreenSprite);
     } else {
-        // Main Menu
-        //window.draw(m_mainMenuSprite);
+#ifdef DEBUG
+        if (m_renderBenchmarkRequested)
+        {
+            // Draws the frames of each render mode, then this frame is drawn as usual
+            m_testGameGrid->BenchmarkRender(window, RENDER_BENCHMARK_FRAMES);
+            m_renderBenchmarkRequested = false;
+            window.clear();
+        }
+#endif
+
+        // Main Menu, behind the grid
+        m_spriteBatch.Draw(m_mainMenuRegion, m_mainMenuSprite.getTransform());
+        m_spriteBatch.Flush(window);
         m_testGameGrid->Render(window);
     }
 }
 
-MainMenuScene::~MainMenuScene() = default;
+MainMenuScene::~MainMenuScene()
+{
+    // Save the modifications since the last autosave, the thread pool still runs
+    if (m_loaded)
+    {
+        try
+        {
+            uint32_t chunkCount = m_testGameGrid->Save();
+            SPDLOG_INFO("Saved {} chunks", chunkCount);
+        }
+        catch (const std::exception& exception)
+        {
+            SPDLOG_ERROR("Exception caught while saving: {}", exception.what());
+        }
+    }
+}
@@ -0,0 +1,276 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <Pathfinder.h>
+#include <GameGrid.h>
+#include <ThreadPool.h>
+#include <RandomNumberGenerator.h>
+#include <algorithm>
+#include <array>
+
+namespace
+{
+    // The search data of a tile, only valid if its generation is the generation of
+    // the current search, so the tiles do not need to be cleared between searches
+    struct SearchTile
+    {
+        uint32_t generation;
+        uint32_t cost; // cost from the start
+        uint32_t parent;
+        bool closed;
+    };
+
+    // The estimates (cost from the start + heuristic) are small integers, and the
+    // estimate of a tile added to the open list is at most ESTIMATE_RANGE - 1 above
+    // the estimate of the tile being visited: the open list is a ring of buckets,
+    // one per estimate, instead of a heap
+    // A step costs at most 255, and the heuristic can decrease by MOVEMENT_COST_FAST
+    constexpr uint32_t ESTIMATE_RANGE = 512;
+}
+
+// The state of a search, kept by the pathfinder between the queries
+struct Pathfinder::SearchState
+{
+    std::vector<SearchTile> tiles;
+    std::array<std::vector<uint32_t>, ESTIMATE_RANGE> openTiles;
+    uint32_t openTileCount = 0;
+    uint32_t generation = 0;
+
+    void Begin(size_t tileCount)
+    {
+        if(tiles.size() < tileCount)
+        {
+            tiles.assign(tileCount, SearchTile{});
+            generation = 0;
+        }
+
+        // When the counter wraps around, the old generations could be valid again
+        if(++generation == 0)
+        {
+            std::fill(tiles.begin(), tiles.end(), SearchTile{});
+            generation = 1;
+        }
+
+        for(std::vector<uint32_t>& bucket : openTiles)
+        {
+            bucket.clear();
+        }
+        openTileCount = 0;
+    }
+
+    void Push(uint32_t estimate, uint32_t index)
+    {
+        openTiles[estimate % ESTIMATE_RANGE].push_back(index);
+        openTileCount++;
+    }
+};
+
+Pathfinder::Pathfinder(const std::vector<uint8_t>& costs, uint32_t width, uint32_t height)
+    : m_costs(costs), m_width(width), m_height(height)
+{
+}
+
+Pathfinder::Pathfinder(const GameGrid& grid)
+    : Pathfinder(grid.GetMovementCosts(), grid.GetWidth(), grid.GetHeight())
+{
+}
+
+Pathfinder::~Pathfinder() = default;
+
+bool Pathfinder::FindPath(sf::Vector2u start, sf::Vector2u goal, std::vector<sf::Vector2u>& path) const
+{
+    path.clear();
+    if(start.x >= m_width || start.y >= m_height || goal.x >= m_width || goal.y >= m_height)
+    {
+        return false;
+    }
+
+    if(m_costs[start.y * m_width + start.x] == 0 || m_costs[goal.y * m_width + goal.x] == 0)
+    {
+        return false;
+    }
+
+    // Take a free search state, or create one if every state is used by a query
+    std::unique_ptr<SearchState> state;
+    {
+        std::lock_guard<std::mutex> lock(m_searchStatesMutex);
+        if(!m_searchStates.empty())
+        {
+            state = std::move(m_searchStates.back());
+            m_searchStates.pop_back();
+        }
+    }
+    if(!state)
+    {
+        state = std::make_unique<SearchState>();
+    }
+
+    bool found = FindPath(*state, start, goal, path);
+
+    std::lock_guard<std::mutex> lock(m_searchStatesMutex);
+    m_searchStates.push_back(std::move(state));
+    return found;
+}
+
+bool Pathfinder::FindPath(SearchState& state, sf::Vector2u start, sf::Vector2u goal,
+                          std::vector<sf::Vector2u>& path) const
+{
+    uint32_t startIndex = start.y * m_width + start.x;
+    uint32_t goalIndex = goal.y * m_width + goal.x;
+    state.Begin(m_costs.size());
+
+    auto heuristic = [goal](uint32_t x, uint32_t y)
+    {
+        uint32_t distance = (x > goal.x ? x - goal.x : goal.x - x) + (y > goal.y ? y - goal.y : goal.y - y);
+        return distance * GameGrid::MOVEMENT_COST_FAST;
+    };
+
+    state.tiles[startIndex] = {state.generation, 0, startIndex, false};
+    uint32_t estimate = heuristic(start.x, start.y);
+    state.Push(estimate, startIndex);
+
+    while(state.openTileCount > 0)
+    {
+        // The heuristic is consistent, so the estimates of the visited tiles never decrease
+        while(state.openTiles[estimate % ESTIMATE_RANGE].empty())
+        {
+            estimate++;
+        }
+
+        // The last tile added is taken first, which favors the tiles closest to the goal
+        std::vector<uint32_t>& bucket = state.openTiles[estimate % ESTIMATE_RANGE];
+        uint32_t index = bucket.back();
+        bucket.pop_back();
+        state.openTileCount--;
+
+        // A tile can be in the open list several times, only its cheapest entry is visited
+        SearchTile& tile = state.tiles[index];
+        if(tile.closed)
+        {
+            continue;
+        }
+        tile.closed = true;
+
+        if(index == goalIndex)
+        {
+            // Walk back from the goal, then put the tiles in order
+            for(uint32_t pathTile = goalIndex; pathTile != startIndex; pathTile = state.tiles[pathTile].parent)
+            {
+                path.emplace_back(pathTile % m_width, pathTile / m_width);
+            }
+            path.push_back(start);
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+
+        uint32_t x = index % m_width;
+        uint32_t y = index / m_width;
+        auto visit = [&](uint32_t neighborX, uint32_t neighborY, uint32_t neighbor)
+        {
+            uint8_t stepCost = m_costs[neighbor];
+            if(stepCost == 0)
+            {
+                return;
+            }
+
+            uint32_t cost = tile.cost + stepCost;
+            SearchTile& neighborTile = state.tiles[neighbor];
+            if(neighborTile.generation == state.generation && (neighborTile.closed || cost >= neighborTile.cost))
+            {
+                return;
+            }
+
+            neighborTile = {state.generation, cost, index, false};
+
+            // Only cheaper tiles than MOVEMENT_COST_FAST could lower the estimate, the
+            // path is then not the cheapest, but the search still ends
+            state.Push(std::max(estimate, cost + heuristic(neighborX, neighborY)), neighbor);
+        };
+
+        if(x > 0) visit(x - 1, y, index - 1);
+        if(x + 1 < m_width) visit(x + 1, y, index + 1);
+        if(y > 0) visit(x, y - 1, index - m_width);
+        if(y + 1 < m_height) visit(x, y + 1, index + m_width);
+    }
+
+    return false;
+}
+
+size_t Pathfinder::FindPaths(const std::vector<Request>& requests, std::vector<std::vector<sf::Vector2u>>& paths,
+                             ThreadPool& threadPool) const
+{
+    paths.resize(requests.size());
+
+    // Each thread takes its own search state
+    return threadPool.ParallelFor(requests.size(), 16, [this, &requests, &paths](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            FindPath(requests[i].start, requests[i].goal, paths[i]);
+        }
+    });
+}
+
+void Pathfinder::Benchmark(ThreadPool& threadPool, uint32_t size, uint32_t requestCount)
+{
+    // Mostly ground, with walls, paths and soils
+    std::vector<uint8_t> costs(static_cast<size_t>(size) * size);
+    for(uint8_t& cost : costs)
+    {
+        int32_t roll = RandomNumberGenerator::GetRandomInt(0, 99);
+        cost = roll < 20 ? 0
+            : roll < 35 ? GameGrid::MOVEMENT_COST_FAST
+            : roll < 45 ? GameGrid::MOVEMENT_COST_SLOW
+            : GameGrid::MOVEMENT_COST_NORMAL;
+    }
+
+    auto maximum = static_cast<int32_t>(size - 1);
+    auto randomTile = [maximum](int32_t x, int32_t y, int32_t distance)
+    {
+        return sf::Vector2u(sf::Vector2i(
+            RandomNumberGenerator::GetRandomInt(std::max(x - distance, 0), std::min(x + distance, maximum)),
+            RandomNumberGenerator::GetRandomInt(std::max(y - distance, 0), std::min(y + distance, maximum))));
+    };
+
+    // The first half of the queries cross the grid, the second half are local
+    std::vector<Request> requests(requestCount);
+    for(size_t i = 0; i < requests.size(); i++)
+    {
+        Request& request = requests[i];
+        request.start = randomTile(0, 0, maximum);
+        request.goal = i < requests.size() / 2 ? randomTile(0, 0, maximum)
+            : randomTile(static_cast<int32_t>(request.start.x), static_cast<int32_t>(request.start.y), LOCAL_DISTANCE);
+    }
+    std::vector<Request> globalRequests(requests.begin(), requests.begin() + requestCount / 2);
+    std::vector<Request> localRequests(requests.begin() + requestCount / 2, requests.end());
+
+    Pathfinder pathfinder(costs, size, size);
+    std::vector<std::vector<sf::Vector2u>> paths(requestCount);
+
+    // The first run creates the search states and sizes the paths
+    pathfinder.FindPaths(requests, paths, threadPool);
+    size_t foundCount = std::count_if(paths.begin(), paths.end(), [](const auto& path) { return !path.empty(); });
+
+    auto measure = [&pathfinder, &paths, &threadPool, size](const std::vector<Request>& measuredRequests, const char* name)
+    {
+        sf::Clock clock;
+        for(size_t i = 0; i < measuredRequests.size(); i++)
+        {
+            pathfinder.FindPath(measuredRequests[i].start, measuredRequests[i].goal, paths[i]);
+        }
+        float singleThreadTime = clock.restart().asSeconds();
+
+        size_t threadCount = pathfinder.FindPaths(measuredRequests, paths, threadPool);
+        float threadPoolTime = clock.getElapsedTime().asSeconds();
+
+        SPDLOG_INFO("[Pathfinder] {}x{} grid, {} {} requests: {:.0f} paths/s on 1 thread, {:.0f} paths/s on {} threads",
+            size, size, measuredRequests.size(), name,
+            static_cast<float>(measuredRequests.size()) / singleThreadTime,
+            static_cast<float>(measuredRequests.size()) / threadPoolTime,
+            threadCount);
+    };
+
+    SPDLOG_INFO("[Pathfinder] {} of {} paths found", foundCount, requestCount);
+    measure(globalRequests, "global");
+    measure(localRequests, "local");
+}
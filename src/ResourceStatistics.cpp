@@ -0,0 +1,114 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <ResourceStatistics.h>
+#include <algorithm>
+#include <fstream>
+
+namespace
+{
+    // Writes a string with the characters JSON needs escaped
+    void WriteJsonString(std::ostream& stream, const std::string& string)
+    {
+        stream << '"';
+        for(char c : string)
+        {
+            switch(c)
+            {
+            case '"': stream << "\\\""; break;
+            case '\\': stream << "\\\\"; break;
+            case '\n': stream << "\\n"; break;
+            case '\r': stream << "\\r"; break;
+            case '\t': stream << "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20)
+                    stream << fmt::format("\\u{:04x}", static_cast<int>(c));
+                else
+                    stream << c;
+            }
+        }
+        stream << '"';
+    }
+}
+
+void ResourceStatisticsReport::Log(const std::vector<ResourceRegistryStatistics>& registries)
+{
+    for(const ResourceRegistryStatistics& registry : registries)
+    {
+        const ResourceRegistryMetrics& metrics = registry.metrics;
+        SPDLOG_INFO("[{}Registry] {} resources, {} KiB RAM, {} KiB VRAM, budget {} KiB, "
+                    "{} hits, {} misses, {} failures, {} evictions, {:.2f} ms loading",
+            registry.typeName, metrics.resourceCount,
+            metrics.residentCpuBytes / 1024, metrics.residentGpuBytes / 1024, metrics.budget / 1024,
+            metrics.hits, metrics.misses, metrics.failures, metrics.evictions,
+            static_cast<double>(metrics.totalLoadTime) / 1000.0);
+
+        // The slowest resources first
+        std::vector<const ResourceStatistics*> resources;
+        for(const ResourceStatistics& resource : registry.resources)
+            resources.push_back(&resource);
+        std::sort(resources.begin(), resources.end(), [](const ResourceStatistics* a, const ResourceStatistics* b)
+        {
+            return a->loadTime > b->loadTime;
+        });
+
+        for(const ResourceStatistics* resource : resources)
+        {
+            SPDLOG_INFO("    {}: {:.2f} ms (decode {:.2f} ms, upload {:.2f} ms), {} KiB RAM, {} KiB VRAM, "
+                        "{} handles, {} hits",
+                resource->path, static_cast<double>(resource->loadTime) / 1000.0,
+                static_cast<double>(resource->decodeTime) / 1000.0, static_cast<double>(resource->uploadTime) / 1000.0,
+                resource->cpuBytes / 1024, resource->gpuBytes / 1024, resource->usageCount, resource->hits);
+        }
+    }
+}
+
+bool ResourceStatisticsReport::WriteJson(const std::vector<ResourceRegistryStatistics>& registries, const std::string& path)
+{
+    std::ofstream file(path);
+    if(!file.is_open())
+    {
+        SPDLOG_ERROR("[ResourceStatisticsReport] Failed to open {}", path);
+        return false;
+    }
+
+    file << "{\n  \"registries\": [";
+    for(size_t i = 0; i < registries.size(); i++)
+    {
+        const ResourceRegistryStatistics& registry = registries[i];
+        const ResourceRegistryMetrics& metrics = registry.metrics;
+
+        file << (i == 0 ? "\n" : ",\n") << "    {\n      \"type\": ";
+        WriteJsonString(file, registry.typeName);
+        file << ",\n"
+             << "      \"resourceCount\": " << metrics.resourceCount << ",\n"
+             << "      \"residentCpuBytes\": " << metrics.residentCpuBytes << ",\n"
+             << "      \"residentGpuBytes\": " << metrics.residentGpuBytes << ",\n"
+             << "      \"budget\": " << metrics.budget << ",\n"
+             << "      \"hits\": " << metrics.hits << ",\n"
+             << "      \"misses\": " << metrics.misses << ",\n"
+             << "      \"failures\": " << metrics.failures << ",\n"
+             << "      \"evictions\": " << metrics.evictions << ",\n"
+             << "      \"totalLoadTimeUs\": " << metrics.totalLoadTime << ",\n"
+             << "      \"resources\": [";
+
+        for(size_t j = 0; j < registry.resources.size(); j++)
+        {
+            const ResourceStatistics& resource = registry.resources[j];
+            file << (j == 0 ? "\n" : ",\n") << "        { \"path\": ";
+            WriteJsonString(file, resource.path);
+            file << ", \"usageCount\": " << resource.usageCount
+                 << ", \"hits\": " << resource.hits
+                 << ", \"loadTimeUs\": " << resource.loadTime
+                 << ", \"decodeTimeUs\": " << resource.decodeTime
+                 << ", \"uploadTimeUs\": " << resource.uploadTime
+                 << ", \"cpuBytes\": " << resource.cpuBytes
+                 << ", \"gpuBytes\": " << resource.gpuBytes << " }";
+        }
+
+        file << (registry.resources.empty() ? "]\n" : "\n      ]\n") << "    }";
+    }
+    file << (registries.empty() ? "]\n" : "\n  ]\n") << "}\n";
+
+    return file.good();
+}
@@ -0,0 +1,53 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <SpriteBatch.h>
+
+void SpriteBatch::Draw(const TextureAtlas::Region& region, const sf::Transform& transform, sf::Color color)
+{
+    // Start a new batch when the texture changes
+    if(m_batches.empty() || m_batches.back().texture != region.texture)
+    {
+        m_batches.push_back({region.texture, m_vertices.size(), 0});
+    }
+
+    auto width = static_cast<float>(region.rect.width);
+    auto height = static_cast<float>(region.rect.height);
+    auto left = static_cast<float>(region.rect.left);
+    auto top = static_cast<float>(region.rect.top);
+
+    sf::Vertex topLeft(transform.transformPoint({0, 0}), color, {left, top});
+    sf::Vertex topRight(transform.transformPoint({width, 0}), color, {left + width, top});
+    sf::Vertex bottomLeft(transform.transformPoint({0, height}), color, {left, top + height});
+    sf::Vertex bottomRight(transform.transformPoint({width, height}), color, {left + width, top + height});
+
+    // Two triangles per sprite, in the same order as the grid
+    m_vertices.push_back(topLeft);
+    m_vertices.push_back(topRight);
+    m_vertices.push_back(bottomLeft);
+    m_vertices.push_back(topRight);
+    m_vertices.push_back(bottomRight);
+    m_vertices.push_back(bottomLeft);
+
+    m_batches.back().vertexCount += 6;
+}
+
+void SpriteBatch::Draw(const sf::Sprite& sprite)
+{
+    Draw({sprite.getTexture(), sprite.getTextureRect()}, sprite.getTransform());
+}
+
+void SpriteBatch::Flush(sf::RenderTarget& target, sf::RenderStates states)
+{
+    for(const Batch& batch : m_batches)
+    {
+        states.texture = batch.texture;
+        target.draw(m_vertices.data() + batch.firstVertex, batch.vertexCount, sf::PrimitiveType::Triangles, states);
+    }
+
+    m_lastDrawCallCount = m_batches.size();
+
+    // Keep the capacity for the next frame
+    m_vertices.clear();
+    m_batches.clear();
+}
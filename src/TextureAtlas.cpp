@@ -0,0 +1,214 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <TextureAtlas.h>
+#include <Application.h>
+
+TextureAtlas::Page::Page(uint32_t size) : m_size(size)
+{
+    if(!texture.create({size, size}))
+    {
+        throw std::runtime_error("[TextureAtlas] Failed to create a page of " + std::to_string(size) + " pixels");
+    }
+
+    // A new texture is not initialized, the space left between the regions
+    // must be transparent
+    sf::Image clear;
+    clear.create({size, size}, sf::Color::Transparent);
+    texture.update(clear);
+
+    // At the beginning, the skyline is the bottom of the page
+    m_skyline.push_back({0, 0, size});
+}
+
+bool TextureAtlas::Page::Fit(size_t nodeIndex, sf::Vector2u size, uint32_t& y) const
+{
+    uint32_t x = m_skyline[nodeIndex].x;
+    if(x + size.x > m_size)
+    {
+        return false;
+    }
+
+    // The rectangle lies on the highest node it covers
+    y = 0;
+    int64_t widthLeft = size.x;
+    for(size_t i = nodeIndex; widthLeft > 0; i++)
+    {
+        y = std::max(y, m_skyline[i].y);
+        if(y + size.y > m_size)
+        {
+            return false;
+        }
+        widthLeft -= m_skyline[i].width;
+    }
+
+    return true;
+}
+
+bool TextureAtlas::Page::Insert(sf::Vector2u size, sf::Vector2u& position)
+{
+    // Find the lowest position, then the leftmost
+    size_t bestIndex = m_skyline.size();
+    uint32_t bestY = m_size;
+    for(size_t i = 0; i < m_skyline.size(); i++)
+    {
+        uint32_t y;
+        if(Fit(i, size, y) && y < bestY)
+        {
+            bestIndex = i;
+            bestY = y;
+        }
+    }
+
+    if(bestIndex == m_skyline.size())
+    {
+        return false;
+    }
+
+    position = {m_skyline[bestIndex].x, bestY};
+
+    // Insert the top edge of the rectangle in the skyline
+    m_skyline.insert(m_skyline.begin() + static_cast<int64_t>(bestIndex), {position.x, bestY + size.y, size.x});
+
+    // Shrink or remove the nodes that are now under the rectangle
+    for(size_t i = bestIndex + 1; i < m_skyline.size();)
+    {
+        SkylineNode& previous = m_skyline[i - 1];
+        SkylineNode& node = m_skyline[i];
+        if(node.x >= previous.x + previous.width)
+        {
+            break;
+        }
+
+        uint32_t shrink = previous.x + previous.width - node.x;
+        if(node.width <= shrink)
+        {
+            m_skyline.erase(m_skyline.begin() + static_cast<int64_t>(i));
+            continue;
+        }
+
+        node.x += shrink;
+        node.width -= shrink;
+        break;
+    }
+
+    // Merge the neighbors at the same height
+    for(size_t i = 1; i < m_skyline.size();)
+    {
+        if(m_skyline[i - 1].y == m_skyline[i].y)
+        {
+            m_skyline[i - 1].width += m_skyline[i].width;
+            m_skyline.erase(m_skyline.begin() + static_cast<int64_t>(i));
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    return true;
+}
+
+TextureAtlas::Region TextureAtlas::GetRegion(const std::string& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto iterator = m_regions.find(path);
+        if(iterator != m_regions.end())
+        {
+            return iterator->second;
+        }
+    }
+
+    // Decode the image without holding the lock, the image registry
+    // supports concurrent loads
+    ImageRegistry::ResourceHandle image = Application::GetInstance().GetImageRegistry().GetResource(path);
+    sf::Vector2u size = image->getSize();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Another thread may have packed the image while we were loading it
+    auto iterator = m_regions.find(path);
+    if(iterator != m_regions.end())
+    {
+        return iterator->second;
+    }
+
+    if(size.x == 0 || size.y == 0)
+    {
+        throw std::runtime_error("[TextureAtlas] The image " + path + " is empty");
+    }
+
+    Region region;
+    uint32_t pageSize = std::min(PAGE_SIZE, sf::Texture::getMaximumSize());
+    if(size.x > std::min(MAX_PACKED_SIZE, pageSize / 2) || size.y > std::min(MAX_PACKED_SIZE, pageSize / 2))
+    {
+        // The image is too big, it would waste most of a page
+        m_standaloneTextures.push_back(Application::GetInstance().GetTextureRegistry().GetResource(path));
+        region.texture = m_standaloneTextures.back().GetPointer();
+        region.rect = sf::IntRect({0, 0}, {static_cast<int>(size.x), static_cast<int>(size.y)});
+    }
+    else
+    {
+        sf::Vector2u paddedSize(size.x + 2 * PADDING, size.y + 2 * PADDING);
+        sf::Vector2u position;
+
+        // Try the existing pages first, the last one is the most likely to have some space
+        Page* page = nullptr;
+        for(auto it = m_pages.rbegin(); it != m_pages.rend(); ++it)
+        {
+            if((*it)->Insert(paddedSize, position))
+            {
+                page = it->get();
+                break;
+            }
+        }
+
+        if(page == nullptr)
+        {
+            m_pages.push_back(std::make_unique<Page>(pageSize));
+            page = m_pages.back().get();
+            page->Insert(paddedSize, position);
+
+            SPDLOG_DEBUG("[TextureAtlas] Created page {}", m_pages.size() - 1);
+        }
+
+        page->texture.update(AddGutter(image), position);
+
+        region.texture = &page->texture;
+        region.rect = sf::IntRect(
+            {static_cast<int>(position.x + PADDING), static_cast<int>(position.y + PADDING)},
+            {static_cast<int>(size.x), static_cast<int>(size.y)}
+        );
+    }
+
+    m_regions.emplace(path, region);
+    return region;
+}
+
+sf::Image TextureAtlas::AddGutter(const sf::Image& image)
+{
+    sf::Vector2u size = image.getSize();
+    sf::Image padded;
+    padded.create({size.x + 2 * PADDING, size.y + 2 * PADDING}, sf::Color::Transparent);
+
+    // Each pixel takes the color of the nearest pixel of the image, which
+    // copies the image and extrudes its edges, like Tileset::AddGutters
+    for(uint32_t y = 0; y < size.y + 2 * PADDING; y++)
+    {
+        uint32_t sourceY = std::clamp<int64_t>(static_cast<int64_t>(y) - PADDING, 0, size.y - 1);
+        for(uint32_t x = 0; x < size.x + 2 * PADDING; x++)
+        {
+            uint32_t sourceX = std::clamp<int64_t>(static_cast<int64_t>(x) - PADDING, 0, size.x - 1);
+            padded.setPixel({x, y}, image.getPixel({sourceX, sourceY}));
+        }
+    }
+
+    return padded;
+}
+
+size_t TextureAtlas::GetPageCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pages.size();
+}
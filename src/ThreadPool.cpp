@@ -81,6 +81,84 @@ void ThreadPool::Init()
     SPDLOG_INFO("All threads initialized!");
 }
 
+size_t ThreadPool::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body)
+{
+    grainSize = std::max<size_t>(grainSize, 1);
+    size_t rangeCount = (count + grainSize - 1) / grainSize;
+    if(rangeCount <= 1 || m_threads.empty())
+    {
+        body(0, count);
+        return 1;
+    }
+
+    // Shared with the tasks, a task may start after the loop is finished
+    struct Loop
+    {
+        std::atomic_size_t nextRange = 0;
+        std::atomic_size_t finishedRanges = 0;
+        std::atomic_size_t threadCount = 0;
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::exception_ptr exception;
+    };
+    auto loop = std::make_shared<Loop>();
+
+    // Take ranges until there are none left, the body is only accessed
+    // while the loop is running
+    auto runRanges = [loop, count, grainSize, rangeCount, &body]()
+    {
+        size_t range;
+        bool joined = false;
+        while((range = loop->nextRange++) < rangeCount)
+        {
+            if(!joined)
+            {
+                loop->threadCount++;
+                joined = true;
+            }
+
+            try
+            {
+                body(range * grainSize, std::min(count, (range + 1) * grainSize));
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                if(!loop->exception)
+                {
+                    loop->exception = std::current_exception();
+                }
+            }
+
+            if(++loop->finishedRanges == rangeCount)
+            {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                loop->condition.notify_all();
+            }
+        }
+    };
+
+    size_t helperCount = std::min(m_threads.size(), rangeCount - 1);
+    for(size_t i = 0; i < helperCount; i++)
+    {
+        Enqueue(runRanges);
+    }
+
+    runRanges();
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->condition.wait(lock, [&loop, rangeCount]()
+    {
+        return loop->finishedRanges == rangeCount;
+    });
+
+    if(loop->exception)
+    {
+        std::rethrow_exception(loop->exception);
+    }
+    return loop->threadCount;
+}
+
 void ThreadPool::Terminate()
 {
     {
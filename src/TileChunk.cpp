@@ -0,0 +1,49 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <TileChunk.h>
+#include <Tiles.h>
+
+bool TileChunk::SetTile(uint16_t cell, TileType type, uint16_t textureIndex, const uint8_t* data, uint32_t size)
+{
+    types[cell] = type;
+    textureIndices[cell] = textureIndex;
+
+    // The previous tile may have had custom data
+    soil.erase(cell);
+    passagePoints.erase(cell);
+
+    // Dispatch to the system of the type
+    switch(type)
+    {
+    case TileType::Ground:
+        flags[cell] = GroundTile::FLAGS;
+        return true;
+    case TileType::Wall:
+        flags[cell] = WallTile::FLAGS;
+        return true;
+    case TileType::PassagePoint:
+        flags[cell] = PassagePointTile::FLAGS;
+        return PassagePointTile::ParseData(data, size, passagePoints[cell]);
+    case TileType::Path:
+        flags[cell] = PathTile::FLAGS;
+        return true;
+    case TileType::Soil:
+        flags[cell] = SoilTile::FLAGS;
+        return SoilTile::ParseData(data, size, soil[cell]);
+    default:
+        flags[cell] = 0;
+        return false;
+    }
+}
+
+uint64_t TileChunk::GetMemorySize() const
+{
+    uint64_t size = sizeof(TileChunk) + soil.size() * (sizeof(uint16_t) + sizeof(SoilData));
+    for(const auto& [cell, passagePoint] : passagePoints)
+    {
+        size += sizeof(uint16_t) + sizeof(PassagePointData) + passagePoint.tilemap.capacity();
+    }
+
+    return size;
+}
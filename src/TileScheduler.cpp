@@ -0,0 +1,71 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <TileScheduler.h>
+
+void TileScheduler::SetTickInterval(TileType type, float tickInterval)
+{
+    m_activeSets[static_cast<size_t>(type)].tickInterval = tickInterval;
+}
+
+void TileScheduler::Activate(TileType type, uint64_t tile)
+{
+    ActiveSet& set = m_activeSets[static_cast<size_t>(type)];
+    if(set.positions.emplace(tile, set.tiles.size()).second)
+    {
+        set.tiles.push_back(tile);
+    }
+}
+
+void TileScheduler::Deactivate(TileType type, uint64_t tile)
+{
+    ActiveSet& set = m_activeSets[static_cast<size_t>(type)];
+
+    auto iterator = set.positions.find(tile);
+    if(iterator == set.positions.end())
+    {
+        return;
+    }
+
+    // Move the last tile in the hole, so the tiles stay contiguous
+    size_t position = iterator->second;
+    set.positions.erase(iterator);
+    if(position != set.tiles.size() - 1)
+    {
+        set.tiles[position] = set.tiles.back();
+        set.positions[set.tiles[position]] = position;
+    }
+    set.tiles.pop_back();
+}
+
+uint32_t TileScheduler::Advance(TileType type, float deltaTime)
+{
+    ActiveSet& set = m_activeSets[static_cast<size_t>(type)];
+    if(set.tiles.empty())
+    {
+        // The next tile activated waits for a full interval
+        set.accumulator = 0.0f;
+        return 0;
+    }
+
+    if(set.tickInterval <= 0.0f)
+    {
+        return 1;
+    }
+
+    set.accumulator += deltaTime;
+    auto ticks = static_cast<uint32_t>(set.accumulator / set.tickInterval);
+    set.accumulator -= static_cast<float>(ticks) * set.tickInterval;
+    return ticks;
+}
+
+uint64_t TileScheduler::GetActiveTileCount() const
+{
+    uint64_t count = 0;
+    for(const ActiveSet& set : m_activeSets)
+    {
+        count += set.tiles.size();
+    }
+
+    return count;
+}
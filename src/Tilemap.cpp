@@ -0,0 +1,590 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <Tilemap.h>
+#include <MappedFile.h>
+#include <ChunkCodec.h>
+#include <Tiles.h>
+#include <TilemapJournal.h>
+#include <Application.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+bool Tilemap::LoadFromFile(const std::string& path, ThreadPool* threadPool)
+{
+    // The tiles are parsed directly from the pages of the file, the mapping
+    // is released when the function returns
+    MappedFile file;
+    if(!file.Open(path))
+    {
+        return false;
+    }
+
+    // The files of the version 1 have no magic number
+    uint32_t magic = 0;
+    if(!file.Read(0, magic))
+    {
+        return false;
+    }
+
+    m_parseThreadCount = 1;
+    if(!(magic == FORMAT_MAGIC ? LoadVersion2(file, path, threadPool) : LoadVersion1(file, path)))
+    {
+        return false;
+    }
+
+    // The saved chunks replace the chunks of the file
+    TilemapJournal journal;
+    journal.Open(path, TilemapJournal::Mode::Read);
+    for(const auto& [chunkX, chunkY] : journal.GetChunks())
+    {
+        if(chunkX >= m_chunkCountX || chunkY >= m_chunkCountY)
+        {
+            SPDLOG_WARN("[Tilemap] The saved chunk ({}, {}) is outside of {}", chunkX, chunkY, path);
+            continue;
+        }
+
+        std::shared_ptr<TileChunk> chunk = journal.LoadChunk(chunkX, chunkY);
+        if(chunk != nullptr)
+        {
+            m_chunks[chunkY * m_chunkCountX + chunkX] = std::move(chunk);
+        }
+    }
+
+    return true;
+}
+
+bool Tilemap::LoadVersion1(const MappedFile& file, const std::string& path)
+{
+    RawGameGrid header{};
+    if(!file.Read(0, header))
+    {
+        return false;
+    }
+
+    const uint8_t* tilesetPath = file.GetRange(sizeof(RawGameGrid), header.tilesetPathSize);
+    const uint8_t* tiles = file.GetRange(sizeof(RawGameGrid) + static_cast<uint64_t>(header.tilesetPathSize), header.tilesSize);
+    if(tilesetPath == nullptr || tiles == nullptr)
+    {
+        SPDLOG_ERROR("[Tilemap] {} is truncated", path);
+        return false;
+    }
+
+    // Each tile needs a record, do not allocate the chunks of a map bigger than the file
+    if(static_cast<uint64_t>(header.width) * header.height > header.tilesSize / sizeof(RawGameTile))
+    {
+        SPDLOG_ERROR("[Tilemap] {} is too small for {}x{} tiles", path, header.width, header.height);
+        return false;
+    }
+
+    m_width = header.width;
+    m_height = header.height;
+    m_tilesetPath = std::string(reinterpret_cast<const char*>(tilesetPath), header.tilesetPathSize);
+
+    // Create the chunks containing the tiles
+    m_chunkCountX = (m_width + TileChunk::SIZE - 1) / TileChunk::SIZE;
+    m_chunkCountY = (m_height + TileChunk::SIZE - 1) / TileChunk::SIZE;
+    m_chunks.clear();
+    m_chunks.reserve(static_cast<uint64_t>(m_chunkCountX) * m_chunkCountY);
+    for(uint64_t i = 0; i < static_cast<uint64_t>(m_chunkCountX) * m_chunkCountY; i++)
+    {
+        m_chunks.push_back(std::make_shared<TileChunk>());
+    }
+
+    // Parse tiles, they are stored in row-major order
+    uint64_t tileCount = static_cast<uint64_t>(m_width) * m_height;
+    uint64_t tileIndex = 0;
+    uint64_t offset = 0;
+    while(offset < header.tilesSize)
+    {
+        if(tileIndex == tileCount)
+        {
+            SPDLOG_ERROR("[Tilemap] {} contains more than {} tiles", path, tileCount);
+            return false;
+        }
+
+        auto x = static_cast<uint32_t>(tileIndex % m_width);
+        auto y = static_cast<uint32_t>(tileIndex / m_width);
+        TileChunk& chunk = *m_chunks[(y / TileChunk::SIZE) * m_chunkCountX + x / TileChunk::SIZE];
+        uint32_t size = ParseTile(tiles + offset, header.tilesSize - offset, offset, x, y, chunk, path);
+        if(size == 0)
+        {
+            return false;
+        }
+
+        tileIndex++;
+        offset += size;
+    }
+
+    if(tileIndex != tileCount)
+    {
+        SPDLOG_ERROR("[Tilemap] {} contains {} tiles, expected {}", path, tileIndex, tileCount);
+        return false;
+    }
+
+    // TODO: parse entities
+
+    return true;
+}
+
+bool Tilemap::LoadVersion2(const MappedFile& file, const std::string& path, ThreadPool* threadPool)
+{
+    FileLayout layout;
+    if(!ReadLayout(file, path, layout))
+    {
+        return false;
+    }
+
+    m_width = layout.width;
+    m_height = layout.height;
+    m_tilesetPath = std::move(layout.tilesetPath);
+    m_chunkCountX = (m_width + TileChunk::SIZE - 1) / TileChunk::SIZE;
+    m_chunkCountY = (m_height + TileChunk::SIZE - 1) / TileChunk::SIZE;
+    m_chunks.assign(layout.chunks.size(), nullptr);
+
+    // Each chunk is parsed from its own part of the sections into its own storage
+    std::atomic_bool valid = true;
+    auto parseChunks = [this, &layout, &path, &valid](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end && valid; i++)
+        {
+            const RawChunk& entry = layout.chunks[i];
+            auto chunk = std::make_shared<TileChunk>();
+            if(!ParseChunk(entry, layout.tiles + entry.tilesOffset, layout.tileData + entry.dataOffset,
+                           i % m_chunkCountX, i / m_chunkCountX, *chunk, path))
+            {
+                valid = false;
+                return;
+            }
+            m_chunks[i] = std::move(chunk);
+        }
+    };
+
+    if(threadPool != nullptr)
+    {
+        m_parseThreadCount = threadPool->ParallelFor(m_chunks.size(), PARSE_GRAIN_SIZE, parseChunks);
+    }
+    else
+    {
+        parseChunks(0, m_chunks.size());
+    }
+
+    return valid;
+}
+
+bool Tilemap::ReadLayout(const MappedFile& file, const std::string& path, FileLayout& layout)
+{
+    RawTilemapHeader header{};
+    if(!file.Read(0, header) || header.magic != FORMAT_MAGIC)
+    {
+        SPDLOG_ERROR("[Tilemap] {} is not a tilemap", path);
+        return false;
+    }
+
+    if(header.version != FORMAT_VERSION)
+    {
+        SPDLOG_ERROR("[Tilemap] {} has the unsupported version {}", path, header.version);
+        return false;
+    }
+
+    // Find the sections, the later ones replace the former ones of the same type
+    RawSection tilesetPath{};
+    RawSection chunkIndex{};
+    RawSection tiles{};
+    RawSection tileData{};
+    for(uint16_t i = 0; i < header.sectionCount; i++)
+    {
+        RawSection section{};
+        if(!file.Read(sizeof(RawTilemapHeader) + i * sizeof(RawSection), section))
+        {
+            SPDLOG_ERROR("[Tilemap] The section table of {} is truncated", path);
+            return false;
+        }
+
+        if(file.GetRange(section.offset, section.size) == nullptr)
+        {
+            SPDLOG_ERROR("[Tilemap] The section {} of {} is outside of the file", static_cast<uint32_t>(section.type), path);
+            return false;
+        }
+
+        switch(section.type)
+        {
+        case SectionType::TilesetPath: tilesetPath = section; break;
+        case SectionType::ChunkIndex: chunkIndex = section; break;
+        case SectionType::Tiles: tiles = section; break;
+        case SectionType::TileData: tileData = section; break;
+        default: break;
+        }
+    }
+
+    layout.width = header.width;
+    layout.height = header.height;
+    uint64_t chunkCount = static_cast<uint64_t>((header.width + TileChunk::SIZE - 1) / TileChunk::SIZE)
+        * ((header.height + TileChunk::SIZE - 1) / TileChunk::SIZE);
+    if(chunkIndex.size != chunkCount * sizeof(RawChunk))
+    {
+        SPDLOG_ERROR("[Tilemap] The chunk index of {} does not contain {} chunks", path, chunkCount);
+        return false;
+    }
+
+    // The sections were checked to be inside of the file
+    layout.tilesetPath.assign(reinterpret_cast<const char*>(file.GetRange(tilesetPath.offset, tilesetPath.size)), tilesetPath.size);
+    layout.chunks.resize(chunkCount);
+    std::memcpy(layout.chunks.data(), file.GetRange(chunkIndex.offset, chunkIndex.size), chunkIndex.size);
+    layout.tiles = file.GetRange(tiles.offset, tiles.size);
+    layout.tileData = file.GetRange(tileData.offset, tileData.size);
+
+    // The chunks are then read without any other check
+    uint32_t chunkCountX = (header.width + TileChunk::SIZE - 1) / TileChunk::SIZE;
+    for(uint64_t i = 0; i < chunkCount; i++)
+    {
+        if(!CheckChunk(layout.chunks[i], tiles.size, tileData.size,
+                       static_cast<uint32_t>(i % chunkCountX), static_cast<uint32_t>(i / chunkCountX), path))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Tilemap::CheckChunk(const RawChunk& entry, uint64_t tilesSize, uint64_t dataSize,
+                         uint32_t chunkX, uint32_t chunkY, const std::string& path)
+{
+    if(entry.tilesOffset > tilesSize || entry.tilesSize > tilesSize - entry.tilesOffset
+       || entry.dataOffset > dataSize || entry.dataSize > dataSize - entry.dataOffset)
+    {
+        SPDLOG_ERROR("[Tilemap] The chunk ({}, {}) of {} is outside of its sections", chunkX, chunkY, path);
+        return false;
+    }
+
+    bool raw = entry.encoding == ChunkEncoding::Raw && entry.tilesSize == RAW_CHUNK_SIZE;
+    if(!raw && entry.encoding != ChunkEncoding::Compressed)
+    {
+        SPDLOG_ERROR("[Tilemap] The chunk ({}, {}) of {} has an unknown encoding", chunkX, chunkY, path);
+        return false;
+    }
+
+    return true;
+}
+
+bool Tilemap::ParseChunk(const RawChunk& entry, const uint8_t* tiles, const uint8_t* data,
+                         uint32_t chunkX, uint32_t chunkY, TileChunk& chunk, const std::string& path)
+{
+    // The compressed chunks are decompressed on the stack of the thread parsing them
+    std::array<uint8_t, RAW_CHUNK_SIZE> decompressedTiles;
+    if(entry.encoding == ChunkEncoding::Compressed)
+    {
+        if(!ChunkCodec::Decompress(tiles, entry.tilesSize, decompressedTiles.data(), RAW_CHUNK_SIZE))
+        {
+            SPDLOG_ERROR("[Tilemap] Failed to decompress the chunk ({}, {}) of {}", chunkX, chunkY, path);
+            return false;
+        }
+        tiles = decompressedTiles.data();
+    }
+
+    const uint8_t* types = tiles;
+    const uint8_t* textureIndices = tiles + TileChunk::AREA * sizeof(TileType);
+
+    uint32_t dataOffset = 0;
+    for(uint16_t cell = 0; cell < TileChunk::AREA; cell++)
+    {
+        auto type = static_cast<TileType>(types[cell]);
+        if(type > TileType::Soil)
+        {
+            SPDLOG_ERROR("[Tilemap] Unknown tile type {} in the chunk ({}, {}) of {}",
+                static_cast<int>(type), chunkX, chunkY, path);
+            return false;
+        }
+
+        uint16_t textureIndex;
+        std::memcpy(&textureIndex, textureIndices + cell * sizeof(uint16_t), sizeof(uint16_t));
+
+        // The custom data of the tile, if its record is the next one
+        const uint8_t* tileData = nullptr;
+        uint32_t tileDataSize = 0;
+        if(entry.dataSize - dataOffset >= sizeof(RawTileData))
+        {
+            auto* record = reinterpret_cast<const RawTileData*>(data + dataOffset);
+            if(record->size < sizeof(RawTileData) || record->size > entry.dataSize - dataOffset || record->cell < cell)
+            {
+                SPDLOG_ERROR("[Tilemap] Invalid tile data at offset {} in the chunk ({}, {}) of {}",
+                    dataOffset, chunkX, chunkY, path);
+                return false;
+            }
+
+            if(record->cell == cell)
+            {
+                tileData = record->data;
+                tileDataSize = record->size - sizeof(RawTileData);
+                dataOffset += record->size;
+            }
+        }
+
+        if(!chunk.SetTile(cell, type, textureIndex, tileData, tileDataSize))
+        {
+            // The tile is still usable with default data
+            SPDLOG_WARN("[Tilemap] Invalid custom data for the cell {} of the chunk ({}, {}) in {}",
+                cell, chunkX, chunkY, path);
+        }
+    }
+
+    if(dataOffset != entry.dataSize)
+    {
+        SPDLOG_ERROR("[Tilemap] The chunk ({}, {}) of {} has unused tile data", chunkX, chunkY, path);
+        return false;
+    }
+
+    return true;
+}
+
+uint32_t Tilemap::ParseTile(const uint8_t* record, uint64_t available, uint64_t offset,
+                           uint32_t x, uint32_t y, TileChunk& chunk, const std::string& path)
+{
+    // The records have a variable size, make sure we do not read past the tiles
+    auto* rawTile = reinterpret_cast<const RawGameTile*>(record);
+    if(available < sizeof(RawGameTile) || rawTile->size < sizeof(RawGameTile) || rawTile->size > available)
+    {
+        SPDLOG_ERROR("[Tilemap] Invalid tile record at offset {} in {}", offset, path);
+        return 0;
+    }
+
+    if(rawTile->type > TileType::Soil)
+    {
+        SPDLOG_ERROR("[Tilemap] Unknown tile type {} at offset {} in {}", static_cast<int>(rawTile->type), offset, path);
+        return 0;
+    }
+
+    if(rawTile->textureIndex > UINT16_MAX)
+    {
+        SPDLOG_ERROR("[Tilemap] Invalid texture index {} at offset {} in {}", rawTile->textureIndex, offset, path);
+        return 0;
+    }
+
+    if(!chunk.SetTile(
+        TileChunk::GetCell(x, y),
+        rawTile->type,
+        static_cast<uint16_t>(rawTile->textureIndex),
+        rawTile->data,
+        rawTile->size - sizeof(RawGameTile)
+    ))
+    {
+        // The tile is still usable with default data
+        SPDLOG_WARN("[Tilemap] Invalid custom data for the tile ({}, {}) in {}", x, y, path);
+    }
+
+    return rawTile->size;
+}
+
+uint64_t Tilemap::GetMemorySize() const
+{
+    uint64_t size = sizeof(Tilemap) + m_tilesetPath.size();
+    for(const std::shared_ptr<TileChunk>& chunk : m_chunks)
+    {
+        size += chunk->GetMemorySize();
+    }
+
+    return size;
+}
+
+void Tilemap::SerializeChunk(const TileChunk& chunk, std::vector<uint8_t>& tiles,
+                             std::vector<uint8_t>& data, RawChunk& entry, bool compress)
+{
+    std::array<uint8_t, RAW_CHUNK_SIZE> rawTiles;
+    std::memcpy(rawTiles.data(), chunk.types.data(), TileChunk::AREA * sizeof(TileType));
+    std::memcpy(rawTiles.data() + TileChunk::AREA * sizeof(TileType), chunk.textureIndices.data(),
+                TileChunk::AREA * sizeof(uint16_t));
+
+    tiles.clear();
+    if(compress)
+    {
+        ChunkCodec::Compress(rawTiles.data(), RAW_CHUNK_SIZE, tiles);
+    }
+    entry.encoding = ChunkEncoding::Compressed;
+    if(!compress || tiles.size() >= RAW_CHUNK_SIZE)
+    {
+        tiles.assign(rawTiles.begin(), rawTiles.end());
+        entry.encoding = ChunkEncoding::Raw;
+    }
+
+    // The records are sorted by cell
+    data.clear();
+    for(uint16_t cell = 0; cell < TileChunk::AREA; cell++)
+    {
+        size_t recordStart = data.size();
+        data.resize(recordStart + sizeof(RawTileData));
+        if(chunk.types[cell] == TileType::Soil)
+        {
+            auto iterator = chunk.soil.find(cell);
+            if(iterator != chunk.soil.end())
+            {
+                SoilTile::SerializeData(iterator->second, data);
+            }
+        }
+        else if(chunk.types[cell] == TileType::PassagePoint)
+        {
+            auto iterator = chunk.passagePoints.find(cell);
+            if(iterator != chunk.passagePoints.end())
+            {
+                PassagePointTile::SerializeData(iterator->second, data);
+            }
+        }
+
+        // Only the tiles with custom data have a record
+        if(data.size() == recordStart + sizeof(RawTileData))
+        {
+            data.resize(recordStart);
+            continue;
+        }
+
+        RawTileData record{cell, static_cast<uint32_t>(data.size() - recordStart)};
+        std::memcpy(data.data() + recordStart, &record, sizeof(RawTileData));
+    }
+
+    entry.tilesSize = static_cast<uint32_t>(tiles.size());
+    entry.dataSize = static_cast<uint32_t>(data.size());
+}
+
+uint64_t Tilemap::WriteBenchmarkFile(const std::string& path, uint32_t size, bool compress)
+{
+    uint32_t chunkCount = (size + TileChunk::SIZE - 1) / TileChunk::SIZE;
+    std::vector<RawChunk> index(static_cast<size_t>(chunkCount) * chunkCount);
+    std::vector<uint8_t> tiles;
+    std::vector<uint8_t> tileData;
+    std::vector<uint8_t> chunkTiles;
+    std::vector<uint8_t> chunkData;
+    std::vector<uint8_t> passagePoint;
+    PassagePointTile::SerializeData({"benchmark.htf", 0, 0}, passagePoint);
+
+    // Not the generator of the game, so that the map only depends on its size
+    std::mt19937 generator(size);
+
+    for(uint32_t i = 0; i < index.size(); i++)
+    {
+        // Areas of ground of the same texture, crossed by walls and paths, with a
+        // field of soils and a passage point, like the maps drawn by hand
+        TileChunk chunk;
+        auto field = static_cast<uint16_t>(std::uniform_int_distribution<uint32_t>(0, TileChunk::SIZE - 8)(generator));
+        for(uint16_t cell = 0; cell < TileChunk::AREA; cell++)
+        {
+            uint32_t x = cell % TileChunk::SIZE;
+            uint32_t y = cell / TileChunk::SIZE;
+            auto texture = static_cast<uint16_t>((x / 8 + y / 8) % 4);
+            if(x == 0 || (y == 16 && x % 8 != 4))
+            {
+                chunk.SetTile(cell, TileType::Wall, 8, nullptr, 0);
+            }
+            else if(x == 16)
+            {
+                chunk.SetTile(cell, TileType::Path, 12, nullptr, 0);
+            }
+            else if(x - field < 8 && y - field < 8)
+            {
+                auto moisture = static_cast<uint8_t>(std::uniform_int_distribution<uint32_t>(0, 255)(generator));
+                const uint8_t soil[] = {moisture, 1, 0};
+                chunk.SetTile(cell, TileType::Soil, 16, soil, sizeof(soil));
+            }
+            else
+            {
+                chunk.SetTile(cell, TileType::Ground, texture, nullptr, 0);
+            }
+        }
+        chunk.SetTile(TileChunk::AREA - 1, TileType::PassagePoint, 20, passagePoint.data(),
+                      static_cast<uint32_t>(passagePoint.size()));
+
+        SerializeChunk(chunk, chunkTiles, chunkData, index[i], compress);
+        index[i].tilesOffset = tiles.size();
+        index[i].dataOffset = tileData.size();
+        tiles.insert(tiles.end(), chunkTiles.begin(), chunkTiles.end());
+        tileData.insert(tileData.end(), chunkData.begin(), chunkData.end());
+    }
+
+    const std::string tilesetPath = "tileset.png";
+    RawSection sections[] = {
+        {SectionType::TilesetPath, 0, tilesetPath.size()},
+        {SectionType::ChunkIndex, 0, index.size() * sizeof(RawChunk)},
+        {SectionType::Tiles, 0, tiles.size()},
+        {SectionType::TileData, 0, tileData.size()}
+    };
+    uint64_t offset = sizeof(RawTilemapHeader) + sizeof(sections);
+    for(RawSection& section : sections)
+    {
+        section.offset = offset;
+        offset += section.size;
+    }
+
+    RawTilemapHeader header{FORMAT_MAGIC, FORMAT_VERSION, std::size(sections), size, size};
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(sections), sizeof(sections));
+    file.write(tilesetPath.data(), static_cast<std::streamsize>(tilesetPath.size()));
+    file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(RawChunk)));
+    file.write(reinterpret_cast<const char*>(tiles.data()), static_cast<std::streamsize>(tiles.size()));
+    file.write(reinterpret_cast<const char*>(tileData.data()), static_cast<std::streamsize>(tileData.size()));
+
+    return file ? offset : 0;
+}
+
+void Tilemap::Benchmark(ThreadPool& threadPool)
+{
+    for(uint32_t size : BENCHMARK_SIZES)
+    {
+        for(bool compress : {false, true})
+        {
+            const char* encoding = compress ? "compressed" : "raw";
+            std::string path = (std::filesystem::temp_directory_path()
+                / ("tilemap_benchmark_" + std::to_string(size) + "_" + encoding + ".htf")).string();
+            uint64_t fileSize = WriteBenchmarkFile(path, size, compress);
+            if(fileSize == 0)
+            {
+                SPDLOG_ERROR("[Tilemap] Failed to write the benchmark file {}", path);
+                continue;
+            }
+
+            // The best of a few loads, the first one may read the file from the disk
+            float singleThreadTime = std::numeric_limits<float>::max();
+            float threadPoolTime = std::numeric_limits<float>::max();
+            size_t threadCount = 1;
+            for(uint32_t run = 0; run < BENCHMARK_RUNS; run++)
+            {
+                Tilemap singleThreadTilemap;
+                sf::Clock clock;
+                bool loaded = singleThreadTilemap.LoadFromFile(path);
+                singleThreadTime = std::min(singleThreadTime, clock.restart().asSeconds());
+
+                Tilemap threadPoolTilemap;
+                clock.restart();
+                loaded = threadPoolTilemap.LoadFromFile(path, &threadPool) && loaded;
+                float time = clock.getElapsedTime().asSeconds();
+                if(time < threadPoolTime)
+                {
+                    threadPoolTime = time;
+                    threadCount = threadPoolTilemap.GetParseThreadCount();
+                }
+
+                if(!loaded)
+                {
+                    SPDLOG_ERROR("[Tilemap] Failed to load the benchmark file {}", path);
+                    break;
+                }
+            }
+
+            SPDLOG_INFO("[Tilemap] {}x{} tiles, {}, {} KiB: {:.2f} ms on 1 thread, {:.2f} ms on {} threads ({:.0f} MiB/s)",
+                size, size, encoding, fileSize / 1024, singleThreadTime * 1000.0f, threadPoolTime * 1000.0f,
+                threadCount, static_cast<float>(fileSize) / threadPoolTime / (1024.0f * 1024.0f));
+
+            std::error_code error;
+            std::filesystem::remove(path, error);
+        }
+    }
+}
+
+bool ResourceLoader<Tilemap>::Load(Tilemap& tilemap, const std::string& path, ResourceLoadStatistics& statistics)
+{
+    sf::Clock clock;
+    bool loaded = tilemap.LoadFromFile(path, &Application::GetInstance().GetThreadPool());
+    statistics.decodeTime = clock.getElapsedTime().asMicroseconds();
+    return loaded;
+}
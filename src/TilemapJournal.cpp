@@ -0,0 +1,501 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <TilemapJournal.h>
+#include <MappedFile.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // The table of the CRC-32 (polynomial 0xEDB88320)
+    constexpr std::array<uint32_t, 256> CRC_TABLE = []()
+    {
+        std::array<uint32_t, 256> table{};
+        for(uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t crc = i;
+            for(int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320 : 0);
+            }
+            table[i] = crc;
+        }
+        return table;
+    }();
+
+    uint32_t UpdateCrc(uint32_t crc, const uint8_t* data, size_t size)
+    {
+        for(size_t i = 0; i < size; i++)
+        {
+            crc = CRC_TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+    // Writes a buffer at the end of a file and waits for it to reach the disk
+    bool AppendAndSync(const std::string& path, const std::vector<uint8_t>& buffer)
+    {
+        FILE* file = std::fopen(path.c_str(), "ab");
+        if(file == nullptr)
+        {
+            return false;
+        }
+
+        bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size() && std::fflush(file) == 0;
+#ifdef _WIN32
+        written = written && _commit(_fileno(file)) == 0;
+#else
+        written = written && fsync(fileno(file)) == 0;
+#endif
+
+        return std::fclose(file) == 0 && written;
+    }
+}
+
+TilemapJournal::~TilemapJournal()
+{
+    UnlockWriter();
+}
+
+bool TilemapJournal::Open(const std::string& tilemapPath, Mode mode)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    UnlockWriter();
+    m_path = tilemapPath + JOURNAL_EXTENSION;
+    m_valid = false;
+    m_records.clear();
+    m_size = 0;
+    m_liveSize = 0;
+    m_sequence = 0;
+
+    // A second writer would truncate the saves of the first one, it only reads the journal
+    m_mode = mode;
+    if(mode == Mode::Write && !LockWriter())
+    {
+        SPDLOG_ERROR("[TilemapJournal] {} is already written by another grid, it is opened to be read", m_path);
+        m_mode = Mode::Read;
+    }
+    bool opened = m_mode == mode;
+
+    // Nothing was saved yet
+    std::error_code error;
+    if(!std::filesystem::exists(m_path, error) || std::filesystem::file_size(m_path, error) == 0)
+    {
+        m_valid = true;
+        return opened;
+    }
+
+    MappedFile file;
+    RawJournalHeader header{};
+    if(!file.Open(m_path) || !file.Read(0, header) || header.magic != JOURNAL_MAGIC || header.version != JOURNAL_VERSION)
+    {
+        SPDLOG_ERROR("[TilemapJournal] {} is not a journal, the saves of the tilemap are ignored", m_path);
+        return false;
+    }
+
+    // Walk the records, the chunks of a save are only indexed once its commit is found
+    std::vector<std::pair<uint64_t, RecordLocation>> pendingRecords;
+    uint64_t offset = sizeof(RawJournalHeader);
+    m_size = offset;
+    while(true)
+    {
+        RawRecord record{};
+        if(!file.Read(offset, record) || record.size < sizeof(RawRecord))
+        {
+            break;
+        }
+
+        const uint8_t* bytes = file.GetRange(offset, record.size);
+        if(bytes == nullptr || GetChecksum(bytes, record.size) != record.checksum)
+        {
+            break;
+        }
+
+        if(record.type == RecordType::Chunk)
+        {
+            RawChunkRecord chunkRecord{};
+            if(record.size < sizeof(RawChunkRecord) || !file.Read(offset, chunkRecord) || !CheckChunkRecord(chunkRecord))
+            {
+                break;
+            }
+
+            pendingRecords.emplace_back(GetKey(chunkRecord.chunkX, chunkRecord.chunkY), RecordLocation{offset, record.size});
+        }
+        else if(record.type == RecordType::Commit)
+        {
+            RawCommitRecord commitRecord{};
+            if(record.size != sizeof(RawCommitRecord) || !file.Read(offset, commitRecord)
+               || commitRecord.chunkCount != pendingRecords.size())
+            {
+                break;
+            }
+
+            // The save is complete, its chunks replace the previous versions
+            for(const auto& [key, location] : pendingRecords)
+            {
+                auto [iterator, inserted] = m_records.try_emplace(key, location);
+                if(!inserted)
+                {
+                    m_liveSize -= iterator->second.size;
+                    iterator->second = location;
+                }
+                m_liveSize += location.size;
+            }
+            pendingRecords.clear();
+            m_sequence = commitRecord.sequence;
+            m_size = offset + record.size;
+        }
+        else
+        {
+            break;
+        }
+
+        offset += record.size;
+    }
+
+    // Remove the interrupted save, the next one is appended after the last commit.
+    // A reader leaves it, as the writer may still be appending it
+    uint64_t fileSize = file.GetSize();
+    file.Close();
+    if(m_size < fileSize && m_mode == Mode::Write)
+    {
+        SPDLOG_WARN("[TilemapJournal] Removed {} bytes of an interrupted save from {}", fileSize - m_size, m_path);
+        std::filesystem::resize_file(m_path, m_size, error);
+        if(error)
+        {
+            SPDLOG_ERROR("[TilemapJournal] Failed to truncate {}: {}", m_path, error.message());
+            return false;
+        }
+    }
+
+    m_valid = true;
+    SPDLOG_INFO("[TilemapJournal] Opened {}, {} chunks saved, {} KiB", m_path, m_records.size(), m_size / 1024);
+    return opened;
+}
+
+bool TilemapJournal::Append(const std::vector<SavedChunk>& chunks)
+{
+    if(!m_valid)
+    {
+        return false;
+    }
+
+    if(m_mode != Mode::Write)
+    {
+        SPDLOG_ERROR("[TilemapJournal] {} was opened to be read, the chunks are not saved", m_path);
+        return false;
+    }
+
+    if(chunks.empty())
+    {
+        return true;
+    }
+
+    // A failed save may have left a part of its records
+    std::error_code error;
+    if(std::filesystem::exists(m_path, error) && std::filesystem::file_size(m_path, error) != m_size)
+    {
+        std::filesystem::resize_file(m_path, m_size, error);
+        if(error)
+        {
+            SPDLOG_ERROR("[TilemapJournal] Failed to truncate {}: {}", m_path, error.message());
+            return false;
+        }
+    }
+
+    std::vector<uint8_t> buffer;
+    if(m_size == 0)
+    {
+        RawJournalHeader header{JOURNAL_MAGIC, JOURNAL_VERSION, 0};
+        auto* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+        buffer.insert(buffer.end(), headerBytes, headerBytes + sizeof(RawJournalHeader));
+    }
+
+    std::vector<std::pair<uint64_t, RecordLocation>> locations;
+    locations.reserve(chunks.size());
+    std::vector<uint8_t> tiles;
+    std::vector<uint8_t> data;
+    for(const SavedChunk& savedChunk : chunks)
+    {
+        RawChunkRecord chunkRecord{};
+        Tilemap::SerializeChunk(*savedChunk.chunk, tiles, data, chunkRecord.entry);
+        chunkRecord.entry.tilesOffset = 0;
+        chunkRecord.entry.dataOffset = chunkRecord.entry.tilesSize;
+        chunkRecord.chunkX = savedChunk.chunkX;
+        chunkRecord.chunkY = savedChunk.chunkY;
+        chunkRecord.record.type = RecordType::Chunk;
+        chunkRecord.record.size = static_cast<uint32_t>(sizeof(RawChunkRecord) + tiles.size() + data.size());
+
+        size_t recordStart = buffer.size();
+        auto* recordBytes = reinterpret_cast<const uint8_t*>(&chunkRecord);
+        buffer.insert(buffer.end(), recordBytes, recordBytes + sizeof(RawChunkRecord));
+        buffer.insert(buffer.end(), tiles.begin(), tiles.end());
+        buffer.insert(buffer.end(), data.begin(), data.end());
+
+        uint32_t checksum = GetChecksum(buffer.data() + recordStart, chunkRecord.record.size);
+        std::memcpy(buffer.data() + recordStart + offsetof(RawRecord, checksum), &checksum, sizeof(uint32_t));
+
+        locations.emplace_back(GetKey(savedChunk.chunkX, savedChunk.chunkY),
+                               RecordLocation{m_size + recordStart, chunkRecord.record.size});
+    }
+
+    // The save is only applied if the commit is read back
+    RawCommitRecord commitRecord{{RecordType::Commit, sizeof(RawCommitRecord), 0},
+                                 static_cast<uint32_t>(chunks.size()), m_sequence + 1};
+    commitRecord.record.checksum = GetChecksum(reinterpret_cast<const uint8_t*>(&commitRecord), sizeof(RawCommitRecord));
+    auto* commitBytes = reinterpret_cast<const uint8_t*>(&commitRecord);
+    buffer.insert(buffer.end(), commitBytes, commitBytes + sizeof(RawCommitRecord));
+
+    if(!AppendAndSync(m_path, buffer))
+    {
+        SPDLOG_ERROR("[TilemapJournal] Failed to write {} chunks to {}", chunks.size(), m_path);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(const auto& [key, location] : locations)
+        {
+            auto [iterator, inserted] = m_records.try_emplace(key, location);
+            if(!inserted)
+            {
+                m_liveSize -= iterator->second.size;
+                iterator->second = location;
+            }
+            m_liveSize += location.size;
+        }
+        m_size += buffer.size();
+        m_sequence++;
+    }
+
+    SPDLOG_DEBUG("[TilemapJournal] Saved {} chunks to {}, {} KiB", chunks.size(), m_path, buffer.size() / 1024);
+
+    if(m_size > COMPACTION_MIN_SIZE && m_size > COMPACTION_RATIO * m_liveSize)
+    {
+        Compact();
+    }
+
+    return true;
+}
+
+bool TilemapJournal::Compact()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::ifstream journal(m_path, std::ios::binary);
+    if(!journal.is_open())
+    {
+        return false;
+    }
+
+    // Copy the last versions in the order of the journal, as a single save
+    std::vector<std::pair<uint64_t, RecordLocation>> records(m_records.begin(), m_records.end());
+    std::sort(records.begin(), records.end(), [](const auto& a, const auto& b)
+    {
+        return a.second.offset < b.second.offset;
+    });
+
+    RawJournalHeader header{JOURNAL_MAGIC, JOURNAL_VERSION, 0};
+    auto* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+    std::vector<uint8_t> buffer(headerBytes, headerBytes + sizeof(RawJournalHeader));
+    buffer.reserve(sizeof(RawJournalHeader) + m_liveSize + sizeof(RawCommitRecord));
+    for(auto& [key, location] : records)
+    {
+        size_t recordStart = buffer.size();
+        buffer.resize(recordStart + location.size);
+        journal.seekg(static_cast<std::streamoff>(location.offset));
+        if(!journal.read(reinterpret_cast<char*>(buffer.data() + recordStart), location.size))
+        {
+            return false;
+        }
+        location.offset = recordStart;
+    }
+    journal.close();
+
+    RawCommitRecord commitRecord{{RecordType::Commit, sizeof(RawCommitRecord), 0},
+                                 static_cast<uint32_t>(records.size()), m_sequence};
+    commitRecord.record.checksum = GetChecksum(reinterpret_cast<const uint8_t*>(&commitRecord), sizeof(RawCommitRecord));
+    auto* commitBytes = reinterpret_cast<const uint8_t*>(&commitRecord);
+    buffer.insert(buffer.end(), commitBytes, commitBytes + sizeof(RawCommitRecord));
+
+    // The old journal is only replaced once the new one is on the disk
+    std::string compactedPath = m_path + ".tmp";
+    std::error_code error;
+    std::filesystem::remove(compactedPath, error);
+    if(!AppendAndSync(compactedPath, buffer))
+    {
+        SPDLOG_ERROR("[TilemapJournal] Failed to write {}", compactedPath);
+        return false;
+    }
+
+    std::filesystem::rename(compactedPath, m_path, error);
+    if(error)
+    {
+        SPDLOG_ERROR("[TilemapJournal] Failed to replace {}: {}", m_path, error.message());
+        return false;
+    }
+
+    SPDLOG_INFO("[TilemapJournal] Compacted {} from {} KiB to {} KiB", m_path, m_size / 1024, buffer.size() / 1024);
+    m_records = std::unordered_map<uint64_t, RecordLocation>(records.begin(), records.end());
+    m_size = buffer.size();
+    m_liveSize = buffer.size() - sizeof(RawJournalHeader) - sizeof(RawCommitRecord);
+    return true;
+}
+
+bool TilemapJournal::LockWriter()
+{
+    std::string lockPath = m_path + LOCK_EXTENSION;
+#ifdef _WIN32
+    // The file cannot be opened again while it is open, and is removed when it is closed
+    HANDLE lock = CreateFileA(lockPath.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if(lock == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+#else
+    // The lock is released when the file is closed, even if the program crashed
+    int lock = open(lockPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if(lock < 0)
+    {
+        return false;
+    }
+
+    if(flock(lock, LOCK_EX | LOCK_NB) != 0)
+    {
+        close(lock);
+        return false;
+    }
+#endif
+
+    m_lock = lock;
+    return true;
+}
+
+void TilemapJournal::UnlockWriter()
+{
+#ifdef _WIN32
+    if(m_lock != nullptr)
+    {
+        CloseHandle(m_lock);
+        m_lock = nullptr;
+    }
+#else
+    if(m_lock >= 0)
+    {
+        close(m_lock);
+        m_lock = -1;
+    }
+#endif
+}
+
+bool TilemapJournal::Contains(uint32_t chunkX, uint32_t chunkY) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_records.contains(GetKey(chunkX, chunkY));
+}
+
+std::shared_ptr<TileChunk> TilemapJournal::LoadChunk(uint32_t chunkX, uint32_t chunkY) const
+{
+    std::vector<uint8_t> record;
+    {
+        // The journal cannot be replaced while the record is read
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto iterator = m_records.find(GetKey(chunkX, chunkY));
+        if(iterator == m_records.end())
+        {
+            return nullptr;
+        }
+
+        std::ifstream journal(m_path, std::ios::binary);
+        record.resize(iterator->second.size);
+        journal.seekg(static_cast<std::streamoff>(iterator->second.offset));
+        if(!journal.read(reinterpret_cast<char*>(record.data()), static_cast<std::streamsize>(record.size())))
+        {
+            SPDLOG_ERROR("[TilemapJournal] Failed to read the chunk ({}, {}) from {}", chunkX, chunkY, m_path);
+            return nullptr;
+        }
+    }
+
+    // The journal may have been compacted by its writer since it was indexed, so
+    // the record is checked again before being parsed
+    RawChunkRecord chunkRecord{};
+    if(record.size() < sizeof(RawChunkRecord))
+    {
+        SPDLOG_ERROR("[TilemapJournal] The chunk ({}, {}) of {} is corrupted", chunkX, chunkY, m_path);
+        return nullptr;
+    }
+
+    std::memcpy(&chunkRecord, record.data(), sizeof(RawChunkRecord));
+    if(chunkRecord.record.type != RecordType::Chunk || chunkRecord.record.size != record.size()
+       || GetChecksum(record.data(), static_cast<uint32_t>(record.size())) != chunkRecord.record.checksum
+       || chunkRecord.chunkX != chunkX || chunkRecord.chunkY != chunkY || !CheckChunkRecord(chunkRecord))
+    {
+        SPDLOG_ERROR("[TilemapJournal] The chunk ({}, {}) of {} is corrupted", chunkX, chunkY, m_path);
+        return nullptr;
+    }
+
+    auto chunk = std::make_shared<TileChunk>();
+    const uint8_t* tiles = record.data() + sizeof(RawChunkRecord);
+    if(!Tilemap::ParseChunk(chunkRecord.entry, tiles, tiles + chunkRecord.entry.dataOffset, chunkX, chunkY, *chunk, m_path))
+    {
+        return nullptr;
+    }
+
+    return chunk;
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> TilemapJournal::GetChunks() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::pair<uint32_t, uint32_t>> chunks;
+    chunks.reserve(m_records.size());
+    for(const auto& [key, location] : m_records)
+    {
+        chunks.emplace_back(static_cast<uint32_t>(key), static_cast<uint32_t>(key >> 32));
+    }
+
+    return chunks;
+}
+
+uint64_t TilemapJournal::GetSize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
+
+bool TilemapJournal::CheckChunkRecord(const RawChunkRecord& chunkRecord) const
+{
+    // The tiles are followed by the data, both sections are the content of the record
+    uint64_t contentSize = chunkRecord.record.size - sizeof(RawChunkRecord);
+    return static_cast<uint64_t>(chunkRecord.entry.tilesSize) + chunkRecord.entry.dataSize == contentSize
+        && chunkRecord.entry.tilesOffset == 0 && chunkRecord.entry.dataOffset == chunkRecord.entry.tilesSize
+        && Tilemap::CheckChunk(chunkRecord.entry, contentSize, contentSize, chunkRecord.chunkX, chunkRecord.chunkY, m_path);
+}
+
+uint32_t TilemapJournal::GetChecksum(const uint8_t* record, uint32_t size)
+{
+    constexpr size_t checksumOffset = offsetof(RawRecord, checksum);
+    constexpr uint32_t zero = 0;
+
+    uint32_t crc = 0xFFFFFFFF;
+    crc = UpdateCrc(crc, record, checksumOffset);
+    crc = UpdateCrc(crc, reinterpret_cast<const uint8_t*>(&zero), sizeof(uint32_t));
+    crc = UpdateCrc(crc, record + checksumOffset + sizeof(uint32_t), size - checksumOffset - sizeof(uint32_t));
+    return crc ^ 0xFFFFFFFF;
+}
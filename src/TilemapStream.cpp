@@ -0,0 +1,176 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <TilemapStream.h>
+#include <Tilemap.h>
+
+bool TilemapStream::Open(const std::string& path, TilemapJournal::Mode journalMode)
+{
+    if(!m_file.Open(path))
+    {
+        return false;
+    }
+
+    m_journal = std::make_shared<TilemapJournal>();
+    m_journal->Open(path, journalMode);
+
+    // The files of the version 2 already have an index of the chunks
+    uint32_t magic = 0;
+    if(!m_file.Read(0, magic))
+    {
+        return false;
+    }
+
+    if(magic == Tilemap::FORMAT_MAGIC)
+    {
+        return OpenVersion2(path);
+    }
+
+    Tilemap::RawGameGrid header{};
+    if(!m_file.Read(0, header))
+    {
+        return false;
+    }
+
+    const uint8_t* tilesetPath = m_file.GetRange(sizeof(Tilemap::RawGameGrid), header.tilesetPathSize);
+    m_tilesOffset = sizeof(Tilemap::RawGameGrid) + header.tilesetPathSize;
+    const uint8_t* tiles = m_file.GetRange(m_tilesOffset, header.tilesSize);
+    if(tilesetPath == nullptr || tiles == nullptr)
+    {
+        SPDLOG_ERROR("[TilemapStream] {} is truncated", path);
+        return false;
+    }
+
+    // Each tile needs a record, do not allocate the chunks of a map bigger than the file
+    if(static_cast<uint64_t>(header.width) * header.height > header.tilesSize / sizeof(Tilemap::RawGameTile))
+    {
+        SPDLOG_ERROR("[TilemapStream] {} is too small for {}x{} tiles", path, header.width, header.height);
+        return false;
+    }
+
+    m_path = path;
+    m_width = header.width;
+    m_height = header.height;
+    m_tilesetPath.assign(reinterpret_cast<const char*>(tilesetPath), header.tilesetPathSize);
+    m_chunkCountX = (m_width + TileChunk::SIZE - 1) / TileChunk::SIZE;
+    m_chunkCountY = (m_height + TileChunk::SIZE - 1) / TileChunk::SIZE;
+    m_tilesSize = header.tilesSize;
+
+    // Walk the records, only reading the size of each one
+    m_segmentOffsets.assign(static_cast<uint64_t>(m_height) * m_chunkCountX + 1, 0);
+    uint64_t tileCount = static_cast<uint64_t>(m_width) * m_height;
+    uint64_t tileIndex = 0;
+    uint64_t offset = 0;
+    while(offset < header.tilesSize)
+    {
+        if(tileIndex == tileCount)
+        {
+            SPDLOG_ERROR("[TilemapStream] {} contains more than {} tiles", path, tileCount);
+            return false;
+        }
+
+        auto* rawTile = reinterpret_cast<const Tilemap::RawGameTile*>(tiles + offset);
+        if(header.tilesSize - offset < sizeof(Tilemap::RawGameTile)
+           || rawTile->size < sizeof(Tilemap::RawGameTile) || rawTile->size > header.tilesSize - offset)
+        {
+            SPDLOG_ERROR("[TilemapStream] Invalid tile record at offset {} in {}", offset, path);
+            return false;
+        }
+
+        auto x = static_cast<uint32_t>(tileIndex % m_width);
+        auto y = static_cast<uint32_t>(tileIndex / m_width);
+        if(x % TileChunk::SIZE == 0)
+        {
+            m_segmentOffsets[static_cast<uint64_t>(y) * m_chunkCountX + x / TileChunk::SIZE] = offset;
+        }
+
+        tileIndex++;
+        offset += rawTile->size;
+    }
+
+    if(tileIndex != tileCount)
+    {
+        SPDLOG_ERROR("[TilemapStream] {} contains {} tiles, expected {}", path, tileIndex, tileCount);
+        return false;
+    }
+    m_segmentOffsets.back() = header.tilesSize;
+
+    SPDLOG_INFO("[TilemapStream] Indexed {} ({}x{}, {} chunks), {} KiB of index",
+        path, m_width, m_height, m_chunkCountX * m_chunkCountY, GetMemorySize() / 1024);
+
+    return true;
+}
+
+bool TilemapStream::OpenVersion2(const std::string& path)
+{
+    Tilemap::FileLayout layout;
+    if(!Tilemap::ReadLayout(m_file, path, layout))
+    {
+        return false;
+    }
+
+    m_path = path;
+    m_width = layout.width;
+    m_height = layout.height;
+    m_tilesetPath = std::move(layout.tilesetPath);
+    m_chunkCountX = (m_width + TileChunk::SIZE - 1) / TileChunk::SIZE;
+    m_chunkCountY = (m_height + TileChunk::SIZE - 1) / TileChunk::SIZE;
+    m_chunks = std::move(layout.chunks);
+    m_tiles = layout.tiles;
+    m_tileData = layout.tileData;
+    m_segmentOffsets.clear();
+
+    SPDLOG_INFO("[TilemapStream] Opened {} ({}x{}, {} chunks), {} KiB of index",
+        path, m_width, m_height, m_chunkCountX * m_chunkCountY, GetMemorySize() / 1024);
+
+    return true;
+}
+
+std::shared_ptr<TileChunk> TilemapStream::LoadChunk(uint32_t chunkX, uint32_t chunkY) const
+{
+    if(m_journal != nullptr && m_journal->Contains(chunkX, chunkY))
+    {
+        return m_journal->LoadChunk(chunkX, chunkY);
+    }
+
+    auto chunk = std::make_shared<TileChunk>();
+    if(!m_chunks.empty())
+    {
+        // The chunks of the index were checked when the file was opened
+        const Tilemap::RawChunk& entry = m_chunks[chunkY * m_chunkCountX + chunkX];
+        if(!Tilemap::ParseChunk(entry, m_tiles + entry.tilesOffset, m_tileData + entry.dataOffset,
+                                chunkX, chunkY, *chunk, m_path))
+        {
+            return nullptr;
+        }
+
+        return chunk;
+    }
+
+    uint32_t firstX = chunkX * TileChunk::SIZE;
+    uint32_t firstY = chunkY * TileChunk::SIZE;
+    uint32_t lastX = std::min(firstX + TileChunk::SIZE, m_width);
+    uint32_t lastY = std::min(firstY + TileChunk::SIZE, m_height);
+
+    const uint8_t* tiles = m_file.GetRange(m_tilesOffset, m_tilesSize);
+    for(uint32_t y = firstY; y < lastY; y++)
+    {
+        // The records of a row segment are contiguous
+        uint64_t segmentIndex = static_cast<uint64_t>(y) * m_chunkCountX + chunkX;
+        uint64_t segmentStart = m_segmentOffsets[segmentIndex];
+        uint64_t segmentEnd = m_segmentOffsets[segmentIndex + 1];
+
+        uint64_t offset = segmentStart;
+        for(uint32_t x = firstX; x < lastX; x++)
+        {
+            uint32_t size = Tilemap::ParseTile(tiles + offset, segmentEnd - offset, offset, x, y, *chunk, m_path);
+            if(size == 0)
+            {
+                return nullptr;
+            }
+            offset += size;
+        }
+    }
+
+    return chunk;
+}
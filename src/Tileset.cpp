@@ -0,0 +1,90 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include <Tileset.h>
+
+bool Tileset::LoadFromFile(const std::string& path, ResourceLoadStatistics& statistics)
+{
+    sf::Clock clock;
+    sf::Image source;
+    if(!source.loadFromFile(path))
+    {
+        return false;
+    }
+
+    m_columns = source.getSize().x / TILE_SIZE;
+    m_rows = source.getSize().y / TILE_SIZE;
+    if(m_columns == 0 || m_rows == 0)
+    {
+        SPDLOG_ERROR("[Tileset] {} is smaller than a tile", path);
+        m_columns = 1;
+        m_rows = 0;
+        return false;
+    }
+
+    m_tileOrigins.resize(static_cast<size_t>(m_columns) * m_rows);
+    for(uint32_t i = 0; i < m_tileOrigins.size(); i++)
+    {
+        m_tileOrigins[i] = {
+            static_cast<float>(i % m_columns * CELL_SIZE + GUTTER),
+            static_cast<float>(i / m_columns * CELL_SIZE + GUTTER)
+        };
+    }
+
+    sf::Image padded = AddGutters(source, m_columns, m_rows);
+    statistics.decodeTime = clock.restart().asMicroseconds();
+
+    if(!m_texture.loadFromImage(padded))
+    {
+        return false;
+    }
+
+    m_texture.setSmooth(false);
+    if(!m_texture.generateMipmap())
+    {
+        // The grid still renders, but shimmers when zoomed out
+        SPDLOG_WARN("[Tileset] Failed to generate the mipmaps of {}", path);
+    }
+    statistics.uploadTime = clock.getElapsedTime().asMicroseconds();
+
+    return true;
+}
+
+sf::Image Tileset::AddGutters(const sf::Image& source, uint32_t columns, uint32_t rows)
+{
+    sf::Image padded;
+    padded.create({columns * CELL_SIZE, rows * CELL_SIZE}, sf::Color::Transparent);
+
+    for(uint32_t row = 0; row < rows; row++)
+    {
+        for(uint32_t column = 0; column < columns; column++)
+        {
+            sf::Vector2u sourceOrigin(column * TILE_SIZE, row * TILE_SIZE);
+            sf::Vector2u cellOrigin(column * CELL_SIZE, row * CELL_SIZE);
+
+            // Each pixel of the cell takes the color of the nearest pixel
+            // of the tile, which copies the tile and extrudes its edges
+            for(uint32_t y = 0; y < CELL_SIZE; y++)
+            {
+                uint32_t sourceY = std::clamp<int64_t>(static_cast<int64_t>(y) - GUTTER, 0, TILE_SIZE - 1);
+                for(uint32_t x = 0; x < CELL_SIZE; x++)
+                {
+                    uint32_t sourceX = std::clamp<int64_t>(static_cast<int64_t>(x) - GUTTER, 0, TILE_SIZE - 1);
+                    padded.setPixel(
+                        {cellOrigin.x + x, cellOrigin.y + y},
+                        source.getPixel({sourceOrigin.x + sourceX, sourceOrigin.y + sourceY})
+                    );
+                }
+            }
+        }
+    }
+
+    return padded;
+}
+
+uint64_t Tileset::GetMemorySize() const
+{
+    // The mipmaps add a third of the size of the base level
+    uint64_t baseSize = static_cast<uint64_t>(m_texture.getSize().x) * m_texture.getSize().y * 4;
+    return baseSize + baseSize / 3;
+}
@@ -1,14 +0,0 @@
-//
-// Created by Killian on 21/03/2023.
-//
-#include <Tiles.h>
-
-GroundTile::GroundTile(uint64_t textureIndex) : Tile(textureIndex)
-{
-
-}
-
-void GroundTile::Update(float deltaTime)
-{
-    // Todo: create particle when walking on it
-}
\ No newline at end of file
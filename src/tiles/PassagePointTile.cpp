@@ -2,13 +2,30 @@
 // Created by Killian on 28/03/2023.
 //
 #include <Tiles.h>
+#include <algorithm>
+#include <cstring>
 
-PassagePointTile::PassagePointTile(uint64_t textureIndex, const uint8_t* data, uint32_t size) : Tile(textureIndex)
+bool PassagePointTile::ParseData(const uint8_t* data, uint32_t size, PassagePointData& passagePoint)
 {
+    if(size < 1 || size != 1 + data[0] + 2 * sizeof(uint32_t))
+    {
+        return false;
+    }
 
+    passagePoint.tilemap.assign(reinterpret_cast<const char*>(data + 1), data[0]);
+    std::memcpy(&passagePoint.x, data + 1 + data[0], sizeof(uint32_t));
+    std::memcpy(&passagePoint.y, data + 1 + data[0] + sizeof(uint32_t), sizeof(uint32_t));
+    return true;
 }
 
-void PassagePointTile::Update(float deltaTime)
+void PassagePointTile::SerializeData(const PassagePointData& passagePoint, std::vector<uint8_t>& data)
 {
+    auto tilemapSize = static_cast<uint8_t>(std::min<size_t>(passagePoint.tilemap.size(), UINT8_MAX));
+    data.push_back(tilemapSize);
+    data.insert(data.end(), passagePoint.tilemap.begin(), passagePoint.tilemap.begin() + tilemapSize);
 
-}
\ No newline at end of file
+    const auto* x = reinterpret_cast<const uint8_t*>(&passagePoint.x);
+    const auto* y = reinterpret_cast<const uint8_t*>(&passagePoint.y);
+    data.insert(data.end(), x, x + sizeof(uint32_t));
+    data.insert(data.end(), y, y + sizeof(uint32_t));
+}
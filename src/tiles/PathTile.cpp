@@ -1,14 +0,0 @@
-//
-// Created by Killian on 28/03/2023.
-//
-#include <Tiles.h>
-
-PathTile::PathTile(uint64_t textureIndex) : Tile(textureIndex)
-{
-
-}
-
-void PathTile::Update(float deltaTime)
-{
-
-}
\ No newline at end of file
@@ -3,12 +3,48 @@
 //
 #include <Tiles.h>
 
-SoilTile::SoilTile(uint64_t textureIndex, const uint8_t* data, uint32_t size) : Tile(textureIndex)
+bool SoilTile::ParseData(const uint8_t* data, uint32_t size, SoilData& soil)
 {
+    if(size == 0)
+    {
+        return true;
+    }
 
+    if(size != 3)
+    {
+        return false;
+    }
+
+    soil.moisture = data[0];
+    soil.crop = data[1];
+    soil.growth = data[2];
+    return true;
+}
+
+void SoilTile::SerializeData(const SoilData& soil, std::vector<uint8_t>& data)
+{
+    if(soil.moisture == 0 && soil.crop == 0 && soil.growth == 0)
+    {
+        return;
+    }
+
+    data.push_back(soil.moisture);
+    data.push_back(soil.crop);
+    data.push_back(soil.growth);
 }
 
-void SoilTile::Update(float deltaTime)
+void SoilTile::Update(SoilData* const* soils, size_t count, uint32_t ticks)
 {
+    for(size_t i = 0; i < count; i++)
+    {
+        SoilData& soil = *soils[i];
 
-}
\ No newline at end of file
+        // The crop only grows during the ticks where the soil is moist
+        auto moistTicks = static_cast<uint8_t>(std::min<uint32_t>(ticks, soil.moisture));
+        soil.moisture -= moistTicks;
+        if(soil.crop != 0)
+        {
+            soil.growth = static_cast<uint8_t>(std::min<uint32_t>(soil.growth + moistTicks, MAX_GROWTH));
+        }
+    }
+}
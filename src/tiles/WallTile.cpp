@@ -1,14 +0,0 @@
-//
-// Created by Killian on 28/03/2023.
-//
-#include <Tiles.h>
-
-WallTile::WallTile(uint64_t textureIndex) : Tile(textureIndex)
-{
-
-}
-
-void WallTile::Update(float deltaTime)
-{
-
-}
\ No newline at end of file
@@ -0,0 +1,32 @@
+//
+// Created by Killian on 19/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+
+////////////////////////////////////////////////////////////
+/// \brief  The checks of the tests
+///
+/// A test is an executable which runs all of its checks, logs
+/// the ones failing, and returns TEST_RESULT from main, which is
+/// not 0 if a check failed.
+///
+////////////////////////////////////////////////////////////
+namespace Check
+{
+    inline uint32_t s_failureCount = 0;
+}
+
+#define CHECK(condition) \
+    do \
+    { \
+        if(!(condition)) \
+        { \
+            SPDLOG_ERROR("[Check] {}:{}: {} failed", __FILE__, __LINE__, #condition); \
+            Check::s_failureCount++; \
+        } \
+    } while(false)
+
+#define TEST_RESULT (Check::s_failureCount == 0 ? 0 : 1)
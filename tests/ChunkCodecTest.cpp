@@ -0,0 +1,75 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include "Check.h"
+#include <ChunkCodec.h>
+#include <random>
+
+namespace
+{
+    // Compresses a buffer and checks that it decompresses to the same bytes
+    void CheckRoundTrip(const std::vector<uint8_t>& data)
+    {
+        std::vector<uint8_t> compressed;
+        ChunkCodec::Compress(data.data(), static_cast<uint32_t>(data.size()), compressed);
+
+        std::vector<uint8_t> decompressed(data.size());
+        CHECK(ChunkCodec::Decompress(compressed.data(), static_cast<uint32_t>(compressed.size()),
+                                     decompressed.data(), static_cast<uint32_t>(decompressed.size())));
+        CHECK(decompressed == data);
+
+        // The size must match exactly
+        if(!data.empty())
+        {
+            std::vector<uint8_t> smaller(data.size() - 1);
+            CHECK(!ChunkCodec::Decompress(compressed.data(), static_cast<uint32_t>(compressed.size()),
+                                          smaller.data(), static_cast<uint32_t>(smaller.size())));
+        }
+
+        // A truncated buffer is rejected
+        if(compressed.size() > 1)
+        {
+            CHECK(!ChunkCodec::Decompress(compressed.data(), static_cast<uint32_t>(compressed.size() - 1),
+                                          decompressed.data(), static_cast<uint32_t>(decompressed.size())));
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<uint32_t> byte(0, 255);
+
+    CheckRoundTrip({});
+    CheckRoundTrip({42});
+    CheckRoundTrip(std::vector<uint8_t>(ChunkCodec::MIN_COPY_LENGTH, 7));
+    CheckRoundTrip(std::vector<uint8_t>(ChunkCodec::MAX_SIZE, 0));
+
+    // Noise, which cannot be compressed
+    std::vector<uint8_t> noise(ChunkCodec::MAX_SIZE);
+    for(uint8_t& value : noise)
+    {
+        value = static_cast<uint8_t>(byte(generator));
+    }
+    CheckRoundTrip(noise);
+
+    // Runs of random lengths, and copies far behind, like the types and the
+    // texture indices of a chunk
+    std::vector<uint8_t> runs;
+    while(runs.size() < 6144)
+    {
+        runs.insert(runs.end(), 1 + byte(generator) % 40, static_cast<uint8_t>(byte(generator) % 4));
+    }
+    runs.insert(runs.end(), runs.begin(), runs.begin() + 1000);
+    CheckRoundTrip(runs);
+
+    // Copies longer than the lengths stored in a single byte
+    std::vector<uint8_t> pattern;
+    for(uint32_t i = 0; i < 4096; i++)
+    {
+        pattern.push_back(static_cast<uint8_t>(i % 5));
+    }
+    CheckRoundTrip(pattern);
+
+    return TEST_RESULT;
+}
@@ -0,0 +1,156 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include "Check.h"
+#include <HierarchicalPathfinder.h>
+#include <GameGrid.h>
+#include <TilemapJournal.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace
+{
+    constexpr uint32_t MAP_SIZE = 192;
+    constexpr uint32_t ROOM_SIZE = 24;
+    constexpr uint32_t QUERY_COUNT = 300;
+
+    // The paths go through the middle of the entrances, so they can be a little
+    // more expensive than the cheapest paths
+    constexpr double MAX_COST_RATIO = 1.2;
+
+    // Writes a map of the version 1: rooms with a door on each side, a road
+    // crossing them, and scattered walls, the same on every platform
+    void WriteMap(const std::string& path)
+    {
+        std::mt19937 generator(7);
+        const std::string tilesetPath = "tileset.png";
+
+#pragma pack(push, 1)
+        struct RawTile
+        {
+            TileType type;
+            uint32_t size;
+            uint32_t textureIndex;
+        };
+#pragma pack(pop)
+
+        std::vector<RawTile> tiles;
+        for(uint32_t y = 0; y < MAP_SIZE; y++)
+        {
+            for(uint32_t x = 0; x < MAP_SIZE; x++)
+            {
+                bool door = x % ROOM_SIZE == ROOM_SIZE / 2 || y % ROOM_SIZE == ROOM_SIZE / 2;
+                TileType type = TileType::Ground;
+                if(y == MAP_SIZE / 2 + 4)
+                {
+                    type = TileType::Path;
+                }
+                else if(((x % ROOM_SIZE == 0 || y % ROOM_SIZE == 0) && !door) || generator() % 100 < 8)
+                {
+                    type = TileType::Wall;
+                }
+                tiles.push_back({type, sizeof(RawTile), 0});
+            }
+        }
+
+        uint32_t header[] = {MAP_SIZE, MAP_SIZE, static_cast<uint32_t>(tilesetPath.size()),
+                             static_cast<uint32_t>(tiles.size() * sizeof(RawTile)), 0};
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.write(tilesetPath.data(), static_cast<std::streamsize>(tilesetPath.size()));
+        file.write(reinterpret_cast<const char*>(tiles.data()), static_cast<std::streamsize>(tiles.size() * sizeof(RawTile)));
+    }
+
+    // Returns the cost of a path, or UINT32_MAX if it is not a walk from start to goal
+    uint32_t GetCost(const GameGrid& grid, const std::vector<sf::Vector2u>& path, sf::Vector2u start, sf::Vector2u goal)
+    {
+        if(path.empty() || path.front() != start || path.back() != goal)
+        {
+            return UINT32_MAX;
+        }
+
+        uint32_t cost = 0;
+        for(size_t i = 1; i < path.size(); i++)
+        {
+            uint32_t distance = (path[i].x > path[i - 1].x ? path[i].x - path[i - 1].x : path[i - 1].x - path[i].x)
+                + (path[i].y > path[i - 1].y ? path[i].y - path[i - 1].y : path[i - 1].y - path[i].y);
+            uint8_t stepCost = grid.GetMovementCost(path[i].x, path[i].y);
+            if(distance != 1 || stepCost == 0)
+            {
+                return UINT32_MAX;
+            }
+            cost += stepCost;
+        }
+        return cost;
+    }
+}
+
+int main()
+{
+    // The map is written where the grids are loaded from
+    const std::string mapName = "pathfinder_test.htf";
+    const std::string mapPath = std::string(TilemapPath) + mapName;
+    WriteMap(mapPath);
+
+    {
+        // The tileset of the grid is loaded by the application, which opens its window
+        std::unique_ptr<GameGrid> grid = GameGrid::ReadFromFile(mapName);
+        HierarchicalPathfinder hierarchicalPathfinder(*grid);
+        Pathfinder pathfinder(*grid);
+
+        std::mt19937 generator(11);
+        auto getWalkableTile = [&generator, &grid]()
+        {
+            while(true)
+            {
+                sf::Vector2u tile(generator() % MAP_SIZE, generator() % MAP_SIZE);
+                if(grid->IsWalkable(tile.x, tile.y))
+                {
+                    return tile;
+                }
+            }
+        };
+
+        uint64_t totalCost = 0;
+        uint64_t totalHierarchicalCost = 0;
+        uint32_t pathCount = 0;
+        std::vector<sf::Vector2u> path;
+        std::vector<sf::Vector2u> hierarchicalPath;
+        for(uint32_t i = 0; i < QUERY_COUNT; i++)
+        {
+            sf::Vector2u start = getWalkableTile();
+            sf::Vector2u goal = getWalkableTile();
+
+            // The abstract graph connects every entrance, so both find a path or none
+            bool found = pathfinder.FindPath(start, goal, path);
+            CHECK(hierarchicalPathfinder.FindPath(start, goal, hierarchicalPath) == found);
+            if(!found || hierarchicalPath.empty())
+            {
+                continue;
+            }
+
+            uint32_t cost = GetCost(*grid, path, start, goal);
+            uint32_t hierarchicalCost = GetCost(*grid, hierarchicalPath, start, goal);
+            CHECK(cost != UINT32_MAX);
+            CHECK(hierarchicalCost != UINT32_MAX);
+            CHECK(hierarchicalCost >= cost);
+
+            totalCost += cost;
+            totalHierarchicalCost += hierarchicalCost;
+            pathCount++;
+        }
+
+        CHECK(pathCount > QUERY_COUNT / 2);
+        CHECK(static_cast<double>(totalHierarchicalCost) <= static_cast<double>(totalCost) * MAX_COST_RATIO);
+        SPDLOG_INFO("[HierarchicalPathfinderTest] {} paths, {} for A*, {} for HPA* ({:.1f}% more)", pathCount,
+            totalCost, totalHierarchicalCost,
+            100.0 * (static_cast<double>(totalHierarchicalCost) / static_cast<double>(std::max<uint64_t>(totalCost, 1)) - 1.0));
+    }
+
+    // The lock of the journal is only removed by the system on Windows
+    std::error_code error;
+    std::filesystem::remove(mapPath, error);
+    std::filesystem::remove(mapPath + TilemapJournal::JOURNAL_EXTENSION + TilemapJournal::LOCK_EXTENSION, error);
+    return TEST_RESULT;
+}
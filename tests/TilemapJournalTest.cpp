@@ -0,0 +1,110 @@
+//
+// Created by Killian on 19/10/2026.
+//
+#include "Check.h"
+#include <TilemapJournal.h>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    // A chunk whose first tile has the given texture
+    std::shared_ptr<TileChunk> CreateChunk(uint16_t textureIndex)
+    {
+        auto chunk = std::make_shared<TileChunk>();
+        chunk->SetTile(0, TileType::Ground, textureIndex, nullptr, 0);
+        return chunk;
+    }
+
+    uint16_t GetTexture(const TilemapJournal& journal, uint32_t chunkX, uint32_t chunkY)
+    {
+        std::shared_ptr<TileChunk> chunk = journal.LoadChunk(chunkX, chunkY);
+        return chunk ? chunk->textureIndices[0] : UINT16_MAX;
+    }
+
+    // Writes two saves to a new journal, and returns the size of the journal after each
+    std::pair<uint64_t, uint64_t> WriteSaves(const std::string& tilemapPath)
+    {
+        std::filesystem::remove(tilemapPath + TilemapJournal::JOURNAL_EXTENSION);
+
+        TilemapJournal journal;
+        CHECK(journal.Open(tilemapPath, TilemapJournal::Mode::Write));
+        CHECK(journal.Append({{0, 0, CreateChunk(1)}}));
+        uint64_t firstSize = journal.GetSize();
+        CHECK(journal.Append({{0, 0, CreateChunk(2)}, {1, 0, CreateChunk(3)}}));
+        return {firstSize, journal.GetSize()};
+    }
+
+    // Checks that only the first save of WriteSaves is loaded
+    void CheckFirstSave(const TilemapJournal& journal)
+    {
+        CHECK(GetTexture(journal, 0, 0) == 1);
+        CHECK(!journal.Contains(1, 0));
+    }
+}
+
+int main()
+{
+    std::string tilemapPath = (std::filesystem::temp_directory_path() / "tilemap_journal_test.htf").string();
+    std::string journalPath = tilemapPath + TilemapJournal::JOURNAL_EXTENSION;
+
+    // Both saves are loaded
+    {
+        WriteSaves(tilemapPath);
+        TilemapJournal journal;
+        CHECK(journal.Open(tilemapPath, TilemapJournal::Mode::Read));
+        CHECK(GetTexture(journal, 0, 0) == 2);
+        CHECK(GetTexture(journal, 1, 0) == 3);
+    }
+
+    // A save interrupted before its commit is ignored, then removed by the writer
+    {
+        auto [firstSize, secondSize] = WriteSaves(tilemapPath);
+        std::filesystem::resize_file(journalPath, secondSize - 1);
+
+        TilemapJournal reader;
+        CHECK(reader.Open(tilemapPath, TilemapJournal::Mode::Read));
+        CheckFirstSave(reader);
+
+        TilemapJournal writer;
+        CHECK(writer.Open(tilemapPath, TilemapJournal::Mode::Write));
+        CheckFirstSave(writer);
+        CHECK(writer.GetSize() == firstSize);
+        CHECK(writer.Append({{1, 0, CreateChunk(4)}}));
+    }
+    {
+        TilemapJournal journal;
+        CHECK(journal.Open(tilemapPath, TilemapJournal::Mode::Read));
+        CHECK(GetTexture(journal, 0, 0) == 1);
+        CHECK(GetTexture(journal, 1, 0) == 4);
+    }
+
+    // A corrupted record rejects its save, and the following ones
+    {
+        auto [firstSize, secondSize] = WriteSaves(tilemapPath);
+        {
+            std::fstream file(journalPath, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekg(static_cast<std::streamoff>(firstSize + 20));
+            char byte = 0;
+            file.read(&byte, 1);
+            byte = static_cast<char>(~byte);
+            file.seekp(static_cast<std::streamoff>(firstSize + 20));
+            file.write(&byte, 1);
+        }
+
+        TilemapJournal journal;
+        CHECK(journal.Open(tilemapPath, TilemapJournal::Mode::Read));
+        CheckFirstSave(journal);
+    }
+
+    // A file which is not a journal is never written
+    {
+        std::ofstream(journalPath, std::ios::binary | std::ios::trunc) << "not a journal";
+        TilemapJournal journal;
+        CHECK(!journal.Open(tilemapPath, TilemapJournal::Mode::Write));
+        CHECK(!journal.IsWritable());
+    }
+
+    std::filesystem::remove(journalPath);
+    return TEST_RESULT;
+}